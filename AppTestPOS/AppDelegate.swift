@@ -17,6 +17,11 @@ class AppDelegate: UIResponder, UIApplicationDelegate {
     func application(_ application: UIApplication, didFinishLaunchingWithOptions launchOptions: [UIApplication.LaunchOptionsKey: Any]?) -> Bool {
         // Override point for customization after application launch.
         sleep(1)
+        #if DEBUG
+        PosBenchmarks.runIfRequested()
+        LinkSimulation.runIfRequested()
+        FuzzHarness.runIfRequested()
+        #endif
         return true
     }
 
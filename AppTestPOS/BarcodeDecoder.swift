@@ -0,0 +1,363 @@
+//
+//  BarcodeDecoder.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import iSMP
+
+/// A GS1 Application Identifier and its value, e.g. (01) 07501031311309.
+struct GS1Element: Equatable {
+    let identifier: String
+    let value: String
+}
+
+struct DecodedBarcode: Equatable {
+    /// One of the `ICBarCode_*` constants (`eICBarCodeSymbologies`).
+    let symbology: Int32
+    /// The scanned data, normalized (UPC-A as EAN-13 when enabled, add-on removed).
+    let data: String
+    let addOn: String?
+    /// Numeric GTIN used as catalog key; `nil` for symbologies that do not carry one.
+    let key: UInt64?
+    let elements: [GS1Element]
+}
+
+enum BarcodeRejection: Error, Equatable {
+    case empty
+    case invalidCharacters
+    case invalidLength
+    case invalidCheckDigit
+    case invalidApplicationIdentifier
+}
+
+/// Validates and normalizes scans delivered by `barcodeData:ofType:`
+/// before they reach the catalog lookup.
+///
+/// Every symbology is described by a row of `rules` (character class, allowed lengths, check
+/// digit and add-on length), so the per-scan work is a table lookup followed by a single pass
+/// over the bytes.
+final class BarcodeDecoder {
+
+    /// Same meaning as `[ICBarCodeReader enableTransmitUPCABarcodesAsEAN13:]`.
+    var transmitUPCAAsEAN13 = true
+    /// Same meaning as `[ICBarCodeReader enableTransmitUPCEBarcodesAsUPCA:]`.
+    var transmitUPCEAsUPCA = true
+
+    private enum CharacterClass {
+        case digits
+        case code39
+        case ascii
+        case any
+    }
+
+    private enum Check {
+        case none
+        case gtin
+        case upce
+        case gs1
+    }
+
+    private struct Rule {
+        let characters: CharacterClass
+        let lengths: ClosedRange<Int>
+        let evenLength: Bool
+        let check: Check
+        let addOn: Int
+    }
+
+    private static let rules: [Int32: Rule] = {
+        let ean13 = Rule(characters: .digits, lengths: 13...13, evenLength: false, check: .gtin, addOn: 0)
+        let ean8 = Rule(characters: .digits, lengths: 8...8, evenLength: false, check: .gtin, addOn: 0)
+        let upca = Rule(characters: .digits, lengths: 12...12, evenLength: false, check: .gtin, addOn: 0)
+        let upce = Rule(characters: .digits, lengths: 8...8, evenLength: false, check: .upce, addOn: 0)
+        let text = Rule(characters: .ascii, lengths: 1...80, evenLength: false, check: .none, addOn: 0)
+        let binary = Rule(characters: .any, lengths: 1...7089, evenLength: false, check: .none, addOn: 0)
+
+        func withAddOn(_ rule: Rule, _ addOn: Int) -> Rule {
+            let lengths = (rule.lengths.lowerBound + addOn)...(rule.lengths.upperBound + addOn)
+            return Rule(characters: rule.characters, lengths: lengths, evenLength: false, check: rule.check, addOn: addOn)
+        }
+
+        return [
+            ICBarCode_EAN13.rawValue: ean13,
+            ICBarCode_EAN8.rawValue: ean8,
+            ICBarCode_UPCA.rawValue: upca,
+            ICBarCode_UPCE.rawValue: upce,
+            ICBarCode_UPCE1.rawValue: upce,
+            ICBarCode_EAN13_2.rawValue: withAddOn(ean13, 2),
+            ICBarCode_EAN8_2.rawValue: withAddOn(ean8, 2),
+            ICBarCode_UPCA_2.rawValue: withAddOn(upca, 2),
+            ICBarCode_UPCE_2.rawValue: withAddOn(upce, 2),
+            ICBarCode_EAN13_5.rawValue: withAddOn(ean13, 5),
+            ICBarCode_EAN8_5.rawValue: withAddOn(ean8, 5),
+            ICBarCode_UPCA_5.rawValue: withAddOn(upca, 5),
+            ICBarCode_UPCE_5.rawValue: withAddOn(upce, 5),
+            ICBarCode_Code39.rawValue: Rule(characters: .code39, lengths: 1...80, evenLength: false, check: .none, addOn: 0),
+            ICBarCode_Interleaved2of5.rawValue: Rule(characters: .digits, lengths: 2...80, evenLength: true, check: .none, addOn: 0),
+            ICBarCode_Standard2of5.rawValue: Rule(characters: .digits, lengths: 1...80, evenLength: false, check: .none, addOn: 0),
+            ICBarCode_Matrix2of5.rawValue: Rule(characters: .digits, lengths: 1...80, evenLength: false, check: .none, addOn: 0),
+            ICBarCode_Code128.rawValue: text,
+            ICBarCode_93.rawValue: text,
+            ICBarCode_GS1_128.rawValue: Rule(characters: .ascii, lengths: 3...80, evenLength: false, check: .gs1, addOn: 0),
+            ICBarCode_GS1_DataBarOmni.rawValue: Rule(characters: .digits, lengths: 14...16, evenLength: false, check: .gs1, addOn: 0),
+            ICBarCode_GS1_DataBarLimited.rawValue: Rule(characters: .digits, lengths: 14...16, evenLength: false, check: .gs1, addOn: 0),
+            ICBarCode_GS1_DataBarExpanded.rawValue: Rule(characters: .ascii, lengths: 3...74, evenLength: false, check: .gs1, addOn: 0),
+            ICBarCode_PDF417.rawValue: binary,
+            ICBarCode_MicroPDF.rawValue: binary,
+            ICBarCode_DataMatrix.rawValue: binary,
+            ICBarCode_QRCode.rawValue: binary,
+            ICBarCode_Aztec.rawValue: binary,
+            ICBarCode_Maxicode.rawValue: binary
+        ]
+    }()
+
+    /* Clase de cada byte: bit 0 dígito, bit 1 Code 39, bit 2 ASCII imprimible (o GS para GS1) */
+    private static let classes: [UInt8] = {
+        var table = [UInt8](repeating: 0, count: 256)
+        for byte in 0x20...0x7E {
+            table[byte] |= 4
+        }
+        table[0x1D] |= 4
+        for byte in UInt8(ascii: "0")...UInt8(ascii: "9") {
+            table[Int(byte)] |= 1 | 2
+        }
+        for byte in UInt8(ascii: "A")...UInt8(ascii: "Z") {
+            table[Int(byte)] |= 2
+        }
+        for byte in " -.$/+%".utf8 {
+            table[Int(byte)] |= 2
+        }
+        return table
+    }()
+
+    private static let gtinWeights: [UInt32] = [1, 3]
+
+    func decode(_ data: String, type: Int32) -> Result<DecodedBarcode, BarcodeRejection> {
+        var bytes = Array(data.utf8)
+        guard !bytes.isEmpty else {
+            return .failure(.empty)
+        }
+        guard let rule = BarcodeDecoder.rules[type] else {
+            return .success(DecodedBarcode(symbology: type, data: data, addOn: nil, key: nil, elements: []))
+        }
+
+        if rule.check == .gs1, bytes.starts(with: Array("]C1".utf8)) || bytes.starts(with: Array("]e0".utf8)) {
+            bytes.removeFirst(3)
+        }
+        guard rule.lengths.contains(bytes.count), !rule.evenLength || bytes.count % 2 == 0 else {
+            return .failure(.invalidLength)
+        }
+        if !BarcodeDecoder.allMatch(bytes, rule.characters) {
+            return .failure(.invalidCharacters)
+        }
+
+        var addOn: String? = nil
+        if rule.addOn > 0 {
+            addOn = String(decoding: bytes.suffix(rule.addOn), as: UTF8.self)
+            bytes.removeLast(rule.addOn)
+        }
+
+        switch rule.check {
+        case .none:
+            return .success(DecodedBarcode(symbology: type, data: String(decoding: bytes, as: UTF8.self), addOn: addOn, key: nil, elements: []))
+
+        case .gtin:
+            guard BarcodeDecoder.hasValidCheckDigit(bytes) else {
+                return .failure(.invalidCheckDigit)
+            }
+            if bytes.count == 12 && transmitUPCAAsEAN13 {
+                bytes.insert(UInt8(ascii: "0"), at: 0)
+            }
+            return .success(DecodedBarcode(symbology: type, data: String(decoding: bytes, as: UTF8.self), addOn: addOn, key: BarcodeDecoder.numericValue(bytes), elements: []))
+
+        case .upce:
+            guard let upca = BarcodeDecoder.expandUPCE(bytes), BarcodeDecoder.hasValidCheckDigit(upca) else {
+                return .failure(.invalidCheckDigit)
+            }
+            var normalized = bytes
+            if transmitUPCEAsUPCA {
+                normalized = upca
+                if transmitUPCAAsEAN13 {
+                    normalized.insert(UInt8(ascii: "0"), at: 0)
+                }
+            }
+            return .success(DecodedBarcode(symbology: type, data: String(decoding: normalized, as: UTF8.self), addOn: addOn, key: BarcodeDecoder.numericValue(upca), elements: []))
+
+        case .gs1:
+            if bytes.count == 14 && (type == ICBarCode_GS1_DataBarOmni.rawValue || type == ICBarCode_GS1_DataBarLimited.rawValue) {
+                bytes.insert(contentsOf: "01".utf8, at: 0)
+            }
+            guard let elements = GS1Parser.parse(bytes) else {
+                return .failure(.invalidApplicationIdentifier)
+            }
+            var key: UInt64? = nil
+            if let gtin = elements.first(where: { $0.identifier == "01" || $0.identifier == "02" }) {
+                let digits = Array(gtin.value.utf8)
+                guard BarcodeDecoder.allMatch(digits, .digits), BarcodeDecoder.hasValidCheckDigit(digits) else {
+                    return .failure(.invalidCheckDigit)
+                }
+                key = BarcodeDecoder.numericValue(digits)
+            }
+            return .success(DecodedBarcode(symbology: type, data: String(decoding: bytes, as: UTF8.self), addOn: nil, key: key, elements: elements))
+        }
+    }
+
+    /// GTIN mod 10: digits weighted 3,1,3,1... from the right (the check digit has weight 1).
+    static func hasValidCheckDigit(_ digits: [UInt8]) -> Bool {
+        var sum: UInt32 = 0
+        let count = digits.count
+        for index in 0..<count {
+            sum += UInt32(digits[index] &- 0x30) * gtinWeights[(count - 1 - index) & 1]
+        }
+        return count > 0 && sum % 10 == 0
+    }
+
+    /// Numeric value of an all-digit key; leading zeros are irrelevant, so UPC-A and its
+    /// EAN-13 form (and any GTIN padded to 14 digits) map to the same key.
+    static func numericValue(_ digits: [UInt8]) -> UInt64 {
+        var value: UInt64 = 0
+        for digit in digits {
+            value = value &* 10 &+ UInt64(digit &- 0x30)
+        }
+        return value
+    }
+
+    /// Expands an 8-digit UPC-E (number system, 6 data digits, check) to its 12-digit UPC-A.
+    static func expandUPCE(_ upce: [UInt8]) -> [UInt8]? {
+        guard upce.count == 8, upce[0] == UInt8(ascii: "0") || upce[0] == UInt8(ascii: "1") else {
+            return nil
+        }
+        let d = Array(upce[1...6])
+        let zero = UInt8(ascii: "0")
+        let manufacturer: [UInt8]
+        let product: [UInt8]
+        switch d[5] {
+        case UInt8(ascii: "0"), UInt8(ascii: "1"), UInt8(ascii: "2"):
+            manufacturer = [d[0], d[1], d[5], zero, zero]
+            product = [zero, zero, d[2], d[3], d[4]]
+        case UInt8(ascii: "3"):
+            manufacturer = [d[0], d[1], d[2], zero, zero]
+            product = [zero, zero, zero, d[3], d[4]]
+        case UInt8(ascii: "4"):
+            manufacturer = [d[0], d[1], d[2], d[3], zero]
+            product = [zero, zero, zero, zero, d[4]]
+        default:
+            manufacturer = [d[0], d[1], d[2], d[3], d[4]]
+            product = [zero, zero, zero, zero, d[5]]
+        }
+        return [upce[0]] + manufacturer + product + [upce[7]]
+    }
+
+    private static func allMatch(_ bytes: [UInt8], _ characters: CharacterClass) -> Bool {
+        let mask: UInt8
+        switch characters {
+        case .digits: mask = 1
+        case .code39: mask = 2
+        case .ascii: mask = 4
+        case .any: return true
+        }
+        var matched = mask
+        for byte in bytes {
+            matched &= classes[Int(byte)]
+        }
+        return matched == mask
+    }
+}
+
+/// Splits GS1 element strings (GS1-128, DataBar) into Application Identifiers.
+///
+/// Variable length fields end with FNC1, transmitted by the scanner as GS (0x1D).
+enum GS1Parser {
+
+    private struct Definition {
+        let identifierLength: Int
+        /// Fixed data length, or 0 when the field is variable up to `maximumLength`.
+        let fixedLength: Int
+        let maximumLength: Int
+    }
+
+    /* Definiciones indexadas por los dos primeros dígitos del AI */
+    private static let definitions: [String: Definition] = [
+        "00": Definition(identifierLength: 2, fixedLength: 18, maximumLength: 18),
+        "01": Definition(identifierLength: 2, fixedLength: 14, maximumLength: 14),
+        "02": Definition(identifierLength: 2, fixedLength: 14, maximumLength: 14),
+        "10": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 20),
+        "11": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "12": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "13": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "15": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "16": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "17": Definition(identifierLength: 2, fixedLength: 6, maximumLength: 6),
+        "20": Definition(identifierLength: 2, fixedLength: 2, maximumLength: 2),
+        "21": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 20),
+        "22": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 20),
+        "24": Definition(identifierLength: 3, fixedLength: 0, maximumLength: 30),
+        "25": Definition(identifierLength: 3, fixedLength: 0, maximumLength: 30),
+        "30": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 8),
+        "31": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "32": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "33": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "34": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "35": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "36": Definition(identifierLength: 4, fixedLength: 6, maximumLength: 6),
+        "37": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 8),
+        "39": Definition(identifierLength: 4, fixedLength: 0, maximumLength: 18),
+        "40": Definition(identifierLength: 3, fixedLength: 0, maximumLength: 30),
+        "41": Definition(identifierLength: 3, fixedLength: 13, maximumLength: 13),
+        "42": Definition(identifierLength: 3, fixedLength: 0, maximumLength: 20),
+        "70": Definition(identifierLength: 4, fixedLength: 0, maximumLength: 30),
+        "80": Definition(identifierLength: 4, fixedLength: 0, maximumLength: 30),
+        "90": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 30),
+        "91": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "92": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "93": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "94": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "95": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "96": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "97": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "98": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90),
+        "99": Definition(identifierLength: 2, fixedLength: 0, maximumLength: 90)
+    ]
+
+    static func parse(_ bytes: [UInt8]) -> [GS1Element]? {
+        let separator: UInt8 = 0x1D
+        var elements: [GS1Element] = []
+        var index = 0
+        while index < bytes.count {
+            if bytes[index] == separator {
+                index += 1
+                continue
+            }
+            guard index + 2 <= bytes.count,
+                let definition = definitions[String(decoding: bytes[index..<(index + 2)], as: UTF8.self)],
+                index + definition.identifierLength <= bytes.count else {
+                return nil
+            }
+            let identifier = bytes[index..<(index + definition.identifierLength)]
+            guard identifier.allSatisfy({ $0 >= 0x30 && $0 <= 0x39 }) else {
+                return nil
+            }
+            let start = index + definition.identifierLength
+            var end: Int
+            if definition.fixedLength > 0 {
+                end = start + definition.fixedLength
+                guard end <= bytes.count else {
+                    return nil
+                }
+            } else {
+                end = bytes[start...].firstIndex(of: separator) ?? bytes.count
+                guard end > start, end - start <= definition.maximumLength else {
+                    return nil
+                }
+            }
+            elements.append(GS1Element(identifier: String(decoding: identifier, as: UTF8.self),
+                                       value: String(decoding: bytes[start..<end], as: UTF8.self)))
+            index = end
+        }
+        return elements.isEmpty ? nil : elements
+    }
+}
@@ -0,0 +1,394 @@
+//
+//  Benchmarks.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+#if DEBUG
+import UIKit
+
+/// One measured case: best-of-`repetitions` time per operation.
+struct BenchmarkResult: Codable {
+    let name: String
+    let iterations: Int
+    let nanosecondsPerOperation: Double
+
+    var operationsPerSecond: Double {
+        return nanosecondsPerOperation > 0 ? 1e9 / nanosecondsPerOperation : 0
+    }
+}
+
+/// A benchmark run, written as JSON so runs can be compared across SDK or app upgrades.
+struct BenchmarkReport: Codable {
+    let date: Date
+    let device: String
+    let system: String
+    let results: [BenchmarkResult]
+
+    func json() -> Data? {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        encoder.dateEncodingStrategy = .iso8601
+        return try? encoder.encode(self)
+    }
+
+    static func load(_ url: URL) -> BenchmarkReport? {
+        let decoder = JSONDecoder()
+        decoder.dateDecodingStrategy = .iso8601
+        return (try? Data(contentsOf: url)).flatMap { try? decoder.decode(BenchmarkReport.self, from: $0) }
+    }
+
+    /// Cases more than `tolerance` (0.1 = 10 %) slower than in `baseline`, with the ratio.
+    func regressions(against baseline: BenchmarkReport, tolerance: Double = 0.1) -> [(String, Double)] {
+        var previous: [String: Double] = [:]
+        for result in baseline.results {
+            previous[result.name] = result.nanosecondsPerOperation
+        }
+        return results.compactMap { result in
+            guard let before = previous[result.name], before > 0 else {
+                return nil
+            }
+            let ratio = result.nanosecondsPerOperation / before
+            return ratio > 1 + tolerance ? (result.name, ratio) : nil
+        }
+    }
+}
+
+/// Benchmarks of the command path: codec micro-benchmarks, then round trips through
+/// `TerminalSession` against `EmulatedTerminalLink` for each command code and with several
+/// sessions at once. Run with the `-runBenchmarks` launch argument.
+enum PosBenchmarks {
+
+    static let launchArgument = "-runBenchmarks"
+    static let repetitions = 5
+
+    static func runIfRequested() {
+        guard ProcessInfo.processInfo.arguments.contains(launchArgument) else {
+            return
+        }
+        DispatchQueue.global(qos: .userInitiated).async {
+            let report = run()
+            guard let json = report.json() else {
+                return
+            }
+            let directory = FileManager.default.urls(for: .documentDirectory, in: .userDomainMask)[0]
+            let latest = directory.appendingPathComponent("benchmarks-latest.json")
+            let baseline = directory.appendingPathComponent("benchmarks-baseline.json")
+            if let previous = BenchmarkReport.load(baseline) {
+                for (name, ratio) in report.regressions(against: previous) {
+                    print("Benchmark regression: \(name) \(String(format: "%.2f", ratio))x")
+                }
+            } else {
+                try? json.write(to: baseline, options: .atomic)
+            }
+            try? json.write(to: latest, options: .atomic)
+            print(String(decoding: json, as: UTF8.self))
+        }
+    }
+
+    /// Runs every case; blocks the calling thread, so do not call it on the main thread.
+    static func run() -> BenchmarkReport {
+        var results: [BenchmarkResult] = []
+        results += codec()
+        results += receipt()
+        results += catalog(skus: 2_000_000)
+        results += offlineQueue()
+        results += roundTrips()
+        results += concurrentSessions(counts: [1, 4, 16])
+        results += serialRoundTrips()
+        results += tcpRoundTrips()
+        results += tlsRoundTrips()
+        return BenchmarkReport(date: Date(), device: UIDevice.current.model,
+                               system: UIDevice.current.systemVersion, results: results)
+    }
+
+    /// Best time of `repetitions` runs of `iterations` calls of `body`.
+    static func measure(_ name: String, iterations: Int, _ body: () -> Void) -> BenchmarkResult {
+        var best = UInt64.max
+        for _ in 0..<repetitions {
+            let start = DispatchTime.now().uptimeNanoseconds
+            for _ in 0..<iterations {
+                body()
+            }
+            best = min(best, DispatchTime.now().uptimeNanoseconds - start)
+        }
+        return BenchmarkResult(name: name, iterations: iterations,
+                               nanosecondsPerOperation: Double(best) / Double(iterations))
+    }
+
+    static func codec() -> [BenchmarkResult] {
+        let command = "0200|15000|123456|||0"
+        let frame = PosFrame.encode(command)
+        let hex = PosFrame.hexEncoded(frame)
+        let reply = Data("0210|00|597029414300|12345678|123456|000001|15000|0|0|6543|1|CR|1810|123456|VI|18102026|120000|0|0".utf8)
+        let replyFrame = PosFrame.encode(payload: reply)
+        let block = Data((0..<4096).map { UInt8(truncatingIfNeeded: $0) })
+        let reusedParser = PosFrameParser()
+        let ring = ByteRing(capacity: 4096)
+        var sink = 0
+
+        let results = [
+            measure("frame.encode", iterations: 20_000) { sink &+= PosFrame.encode(command).count },
+            measure("frame.lrc", iterations: 20_000) { sink &+= Int(PosFrame.lrc(reply)) },
+            measure("checksum.lrc4k", iterations: 20_000) { sink &+= Int(Checksum.lrc(block)) },
+            measure("checksum.crc32c4k", iterations: 20_000) { sink &+= Int(Checksum.crc32c(block)) },
+            measure("hex.encode", iterations: 20_000) { sink &+= PosFrame.hexEncoded(frame).utf8.count },
+            measure("hex.decode", iterations: 20_000) { sink &+= PosFrame.hexDecoded(hex)?.count ?? 0 },
+            measure("response.tokenize", iterations: 20_000) { sink &+= PosResponse(payload: reply).fieldCount },
+            measure("response.decodeSale", iterations: 20_000) { sink &+= SaleResponse(PosResponse(payload: reply))?.amount ?? 0 },
+            measure("parser.feed", iterations: 20_000) {
+                let parser = PosFrameParser()
+                sink &+= parser.feed(replyFrame).count
+            },
+            measure("parser.feedReused", iterations: 20_000) {
+                sink &+= reusedParser.feed(replyFrame).count
+            },
+            measure("ring.writeDrain", iterations: 20_000) {
+                ring.write(replyFrame)
+                ring.drain { sink &+= reusedParser.feed($0).count }
+            },
+        ]
+        blackHole(sink)
+        return results
+    }
+
+    /// Renders a fixed receipt into `EscPosMockPrinter`, checks the bytes against the commands it
+    /// must produce (a new receipt reuses the stored logo; after a power cycle it is stored again),
+    /// then times the rendering.
+    static func receipt(iterations: Int = 2_000) -> [BenchmarkResult] {
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        let logo = UIGraphicsImageRenderer(size: CGSize(width: 64, height: 32), format: format).image { context in
+            UIColor.black.setFill()
+            context.fill(CGRect(x: 8, y: 8, width: 48, height: 16))
+        }
+        guard let raster = EscPosRaster(image: logo, maxDots: 576) else {
+            return []
+        }
+        let title = EscPosReceiptPrinter.TextStyle(alignment: .center, xScale: 2, yScale: 2, underline: false, bold: true)
+        let body = EscPosReceiptPrinter.TextStyle()
+        func render(_ printer: EscPosReceiptPrinter) {
+            printer.printText("TRANSBANK", style: title)
+            printer.printText("VENTA $15.000", style: body)
+            printer.printImage(logo)
+            printer.feed(lines: 3)
+            printer.cut()
+            printer.endReceipt()
+        }
+
+        let key = (UInt8(0x54), UInt8(0x21))
+        let lines = EscPosCommand.encode("TRANSBANK") + EscPosCommand.lineFeed
+            + EscPosCommand.align(.left) + EscPosCommand.size(x: 1, y: 1) + EscPosCommand.bold(false)
+            + EscPosCommand.encode("VENTA $15.000") + EscPosCommand.lineFeed
+            + EscPosCommand.align(.center)
+        let ending = EscPosCommand.printGraphics(key: key) + EscPosCommand.feed(lines: 3) + EscPosCommand.cut
+        let first = EscPosCommand.initialize
+            + EscPosCommand.align(.center) + EscPosCommand.size(x: 2, y: 2) + EscPosCommand.bold(true)
+            + lines + EscPosCommand.storeGraphics(raster, key: key) + ending
+        let second = EscPosCommand.size(x: 2, y: 2) + EscPosCommand.bold(true) + lines + ending
+
+        let mock = EscPosMockPrinter()
+        let printer = EscPosReceiptPrinter(sink: mock)
+        render(printer)
+        render(printer)
+        mock.powerCycle()
+        render(printer)
+        printer.synchronize()
+        if mock.bytes != first + second + first {
+            print("ESC/POS receipt check failed: \(mock.operations())")
+        }
+
+        let result = measure("escpos.receipt", iterations: iterations) {
+            render(printer)
+            printer.synchronize()
+        }
+        return [result]
+    }
+
+    /// Builds and maps a catalog snapshot of `skus` products, then looks up present and absent
+    /// GTINs in random order.
+    static func catalog(skus: Int, lookups: Int = 1_000_000) -> [BenchmarkResult] {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("benchmark-catalog.bin")
+        defer { try? FileManager.default.removeItem(at: url) }
+        let entries = (0..<skus).map { sku -> (key: UInt64, record: String) in
+            (key: 7_800_000_000_000 + UInt64(sku) * 7, record: "SKU\(sku)|Producto \(sku)|\(990 + sku % 50_000)")
+        }
+        let store = CatalogStore()
+        let build = measure("catalog.build.\(skus)", iterations: 1) {
+            try? store.update(entries, at: url)
+        }
+        guard let index = store.index, index.entryCount == skus else {
+            print("Catalog benchmark: snapshot did not load")
+            return [build]
+        }
+
+        var generator = SystemRandomNumberGenerator()
+        let hits = (0..<lookups).map { _ in entries[Int.random(in: 0..<skus, using: &generator)].key }
+        let misses = hits.map { $0 + 1 }
+        var sink = 0
+        var position = 0
+        let results = [
+            build,
+            measure("catalog.lookupHit", iterations: lookups) {
+                sink &+= index.lookup(hits[position % lookups])?.utf8.count ?? 0
+                position &+= 1
+            },
+            measure("catalog.lookupMiss", iterations: lookups) {
+                sink &+= index.contains(misses[position % lookups]) ? 1 : 0
+                position &+= 1
+            },
+        ]
+        blackHole(sink)
+        return results
+    }
+
+    /// Group-committed appends and a drain against a stand-in host, per operation.
+    static func offlineQueue(operations: Int = 2000) -> [BenchmarkResult] {
+        let done = DispatchSemaphore(value: 0)
+        var measured: OfflineQueueBenchmark.Result?
+        OfflineQueueBenchmark.run(operations: operations) { result in
+            measured = result
+            done.signal()
+        }
+        guard done.wait(timeout: .now() + 60) == .success, let result = measured else {
+            return []
+        }
+        return [
+            BenchmarkResult(name: "offlineQueue.append", iterations: operations,
+                            nanosecondsPerOperation: result.appendSeconds * 1e9 / Double(operations)),
+            BenchmarkResult(name: "offlineQueue.drain", iterations: operations,
+                            nanosecondsPerOperation: result.drainSeconds * 1e9 / Double(operations)),
+        ]
+    }
+
+    /// Keeps the benchmarked results alive so the optimizer cannot drop the work.
+    @inline(never)
+    static func blackHole<T>(_ value: T) {
+    }
+
+    static let commands = ["0200|15000|123456|||0", "0250|0", "0260|1", "0500|0", "0700||", "0800", "1200|1|"]
+
+    static func roundTrips(iterations: Int = 200) -> [BenchmarkResult] {
+        let host = TerminalSessionHost(executor: CallbackExecutor(label: "cl.transbank.benchmark"))
+        let session = host.open(identifier: "benchmark", link: EmulatedTerminalLink(detailCount: 20))
+        return commands.map { command in
+            let code = String(command.prefix(4))
+            return measure("roundTrip.\(code)", iterations: iterations) {
+                let done = DispatchSemaphore(value: 0)
+                if code == DetailRecord.code {
+                    session.details(onRecord: { _ in true }, completion: { _ in done.signal() })
+                } else {
+                    session.send(command) { _ in done.signal() }
+                }
+                done.wait()
+            }
+        }
+    }
+
+    /// Sales through `SerialPortLink` against the emulator on a pty; empty where ptys cannot be
+    /// opened (an iOS device).
+    static func serialRoundTrips(iterations: Int = 200) -> [BenchmarkResult] {
+        guard let emulator = try? PseudoTerminalEmulator(),
+              let link = try? SerialPortLink(path: emulator.slavePath) else {
+            return []
+        }
+        let host = TerminalSessionHost(executor: CallbackExecutor(label: "cl.transbank.benchmark.serial"))
+        let session = host.open(identifier: "serial", link: link)
+        let result = measure("serial.roundTrip.0200", iterations: iterations) {
+            let done = DispatchSemaphore(value: 0)
+            session.sale(amount: 15000) { _ in done.signal() }
+            done.wait()
+        }
+        withExtendedLifetime(emulator) {}
+        return [result]
+    }
+
+    /// Sales through `TCPLink` against `EmulatedTerminalListener` on localhost: on one reused
+    /// connection, and with the connection closed before every sale.
+    static func tcpRoundTrips(iterations: Int = 200) -> [BenchmarkResult] {
+        guard #available(iOS 12.0, *) else {
+            return []
+        }
+        guard let listener = try? EmulatedTerminalListener() else {
+            return []
+        }
+        return tcpRoundTrips("tcp", listener: listener, tls: nil, iterations: iterations)
+    }
+
+    /// The same over TLS: the listener presents `benchmark-terminal.p12` (password "benchmark"),
+    /// and `TCPLink` trusts only `benchmark-ca.der`, which signed it, through its verify block.
+    /// Reconnects resume the TLS session from its ticket.
+    static func tlsRoundTrips(iterations: Int = 200) -> [BenchmarkResult] {
+        guard #available(iOS 12.0, *) else {
+            return []
+        }
+        guard let identity = try? TLSSettings.identity(named: "benchmark-terminal", password: "benchmark"),
+              let anchors = try? TLSSettings.anchors(named: "benchmark-ca"), !anchors.isEmpty,
+              let listener = try? EmulatedTerminalListener(tls: identity) else {
+            print("TLS benchmark: test identity not in the bundle")
+            return []
+        }
+        return tcpRoundTrips("tls", listener: listener, tls: TLSSettings(identity: identity, anchors: anchors),
+                             iterations: iterations)
+    }
+
+    @available(iOS 12.0, *)
+    private static func tcpRoundTrips(_ prefix: String, listener: EmulatedTerminalListener, tls: TLSSettings?,
+                                      iterations: Int) -> [BenchmarkResult] {
+        guard listener.start(), let port = listener.port else {
+            return []
+        }
+        let link = TCPLink(host: "127.0.0.1", port: port, tls: tls)
+        let host = TerminalSessionHost(executor: CallbackExecutor(label: "cl.transbank.benchmark.\(prefix)"))
+        let session = host.open(identifier: prefix, link: link)
+        var failures = 0
+        func sale() {
+            let done = DispatchSemaphore(value: 0)
+            session.sale(amount: 15000) { result in
+                if case .failure = result {
+                    failures += 1
+                }
+                done.signal()
+            }
+            done.wait()
+        }
+        let results = [
+            measure("\(prefix).roundTrip.0200", iterations: iterations, sale),
+            measure("\(prefix).reconnect.0200", iterations: iterations / 10) {
+                link.close()
+                sale()
+            },
+        ]
+        if failures > 0 {
+            /* Un handshake rechazado no debe pasar por una medición válida */
+            print("\(prefix) benchmark: \(failures) sales failed")
+        }
+        withExtendedLifetime(listener) {}
+        return failures == 0 ? results : []
+    }
+
+    /// `count` sessions each doing sales back to back; reported per sale.
+    static func concurrentSessions(counts: [Int], salesPerSession: Int = 100) -> [BenchmarkResult] {
+        return counts.map { count in
+            let host = TerminalSessionHost(executor: CallbackExecutor(label: "cl.transbank.benchmark.\(count)"))
+            let sessions = (0..<count).map {
+                host.open(identifier: "terminal-\($0)", link: EmulatedTerminalLink(terminalId: String(format: "%08d", $0)))
+            }
+            let result = measure("concurrent.\(count)", iterations: 1) {
+                let group = DispatchGroup()
+                for session in sessions {
+                    for _ in 0..<salesPerSession {
+                        group.enter()
+                        session.sale(amount: 15000) { _ in group.leave() }
+                    }
+                }
+                group.wait()
+            }
+            return BenchmarkResult(name: result.name, iterations: count * salesPerSession,
+                                   nanosecondsPerOperation: result.nanosecondsPerOperation / Double(count * salesPerSession))
+        }
+    }
+}
+#endif
@@ -0,0 +1,140 @@
+//
+//  ByteRing.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Single-producer, single-consumer byte ring with no locks.
+///
+/// The producer (a stream callback thread) only writes `tail` and the consumer (the protocol
+/// queue) only writes `head`; both are free-running counters, each on its own cache line so
+/// the two sides do not invalidate each other's line on every update. A memory barrier orders
+/// the byte copy against the index store on one side and the index load against the byte
+/// access on the other. `capacity` is rounded up to a power of two.
+///
+/// Exactly one thread may call the producer methods and exactly one the consumer methods.
+final class ByteRing {
+
+    /// 128 bytes: the cache line of Apple's ARM cores (and two of the older 64-byte lines).
+    static let cacheLine = 128
+
+    let capacity: Int
+    private let mask: Int
+    private let storage: UnsafeMutablePointer<UInt8>
+    /// `head` at line 0, `tail` at line 1.
+    private let indices: UnsafeMutableRawPointer
+
+    init(capacity: Int = 64 * 1024) {
+        var size = 1
+        while size < capacity {
+            size <<= 1
+        }
+        self.capacity = size
+        self.mask = size - 1
+        self.storage = UnsafeMutablePointer<UInt8>.allocate(capacity: size)
+        self.indices = UnsafeMutableRawPointer.allocate(byteCount: 2 * ByteRing.cacheLine, alignment: ByteRing.cacheLine)
+        indices.initializeMemory(as: UInt8.self, repeating: 0, count: 2 * ByteRing.cacheLine)
+    }
+
+    deinit {
+        storage.deallocate()
+        indices.deallocate()
+    }
+
+    private var head: UnsafeMutablePointer<Int> {
+        return indices.assumingMemoryBound(to: Int.self)
+    }
+
+    private var tail: UnsafeMutablePointer<Int> {
+        return (indices + ByteRing.cacheLine).assumingMemoryBound(to: Int.self)
+    }
+
+    /// Bytes waiting to be read; exact on the consumer side, a lower bound elsewhere.
+    var count: Int {
+        let tail = self.tail.pointee
+        OSMemoryBarrier()
+        return tail - head.pointee
+    }
+
+    // MARK: - Producer
+
+    /// Copies as much of `bytes` as fits and returns how much that was.
+    @discardableResult
+    func write(_ bytes: UnsafeRawBufferPointer) -> Int {
+        guard let source = bytes.baseAddress else {
+            return 0
+        }
+        let tail = self.tail.pointee
+        let head = self.head.pointee
+        OSMemoryBarrier()
+        let length = min(bytes.count, capacity - (tail - head))
+        let start = tail & mask
+        let first = min(length, capacity - start)
+        (storage + start).initialize(from: source.assumingMemoryBound(to: UInt8.self), count: first)
+        storage.initialize(from: source.assumingMemoryBound(to: UInt8.self) + first, count: length - first)
+        OSMemoryBarrier()
+        self.tail.pointee = tail + length
+        return length
+    }
+
+    @discardableResult
+    func write(_ data: Data) -> Int {
+        return data.withUnsafeBytes { write($0) }
+    }
+
+    /// Free space up to the end of the storage, for a producer that fills it in place (e.g. with
+    /// `read(2)`); call `commit` with the number of bytes written.
+    func writableRegion() -> UnsafeMutableRawBufferPointer {
+        let tail = self.tail.pointee
+        let head = self.head.pointee
+        OSMemoryBarrier()
+        let start = tail & mask
+        return UnsafeMutableRawBufferPointer(start: storage + start, count: min(capacity - (tail - head), capacity - start))
+    }
+
+    /// Publishes `count` bytes written into the last `writableRegion`.
+    func commit(_ count: Int) {
+        OSMemoryBarrier()
+        tail.pointee += count
+    }
+
+    // MARK: - Consumer
+
+    /// The readable bytes up to the end of the storage; the rest (after a wrap) comes in the
+    /// next region once this one is consumed.
+    func readableRegion() -> UnsafeRawBufferPointer {
+        let tail = self.tail.pointee
+        OSMemoryBarrier()
+        let head = self.head.pointee
+        let start = head & mask
+        return UnsafeRawBufferPointer(start: storage + start, count: min(tail - head, capacity - start))
+    }
+
+    /// Releases the first `count` readable bytes to the producer.
+    func consume(_ count: Int) {
+        precondition(count >= 0 && count <= self.count, "consume past the readable bytes")
+        OSMemoryBarrier()
+        head.pointee += count
+    }
+
+    /// Hands every readable byte to `body` in at most two contiguous regions, consuming them as it goes.
+    /// Returns the number of bytes read.
+    @discardableResult
+    func drain(_ body: (UnsafeRawBufferPointer) -> Void) -> Int {
+        var total = 0
+        for _ in 0..<2 {
+            let region = readableRegion()
+            guard !region.isEmpty else {
+                break
+            }
+            body(region)
+            consume(region.count)
+            total += region.count
+        }
+        return total
+    }
+}
@@ -0,0 +1,55 @@
+//
+//  CallbackExecutor.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Runs delegate and session callbacks off the main thread.
+///
+/// Work is submitted to strands: serial queues that all target one concurrent pool, so callbacks
+/// of the same session keep their order while different sessions run in parallel on the worker
+/// threads GCD balances between them. Only the final UIKit update goes through `ui(_:)`.
+final class CallbackExecutor {
+
+    static let shared = CallbackExecutor()
+
+    let pool: DispatchQueue
+
+    private let lock = NSLock()
+    private var strands: [String: DispatchQueue] = [:]
+
+    init(label: String = "cl.transbank.callbacks", qos: DispatchQoS = .userInitiated) {
+        pool = DispatchQueue(label: label, qos: qos, attributes: .concurrent)
+    }
+
+    /// The strand named `name`, created on first use.
+    func strand(_ name: String) -> DispatchQueue {
+        lock.lock()
+        defer { lock.unlock() }
+        if let strand = strands[name] {
+            return strand
+        }
+        let strand = DispatchQueue(label: "\(pool.label).\(name)", target: pool)
+        strands[name] = strand
+        return strand
+    }
+
+    func removeStrand(_ name: String) {
+        lock.lock()
+        strands.removeValue(forKey: name)
+        lock.unlock()
+    }
+
+    /// Runs `work` on the main thread, inline if already there.
+    static func ui(_ work: @escaping () -> Void) {
+        if Thread.isMainThread {
+            work()
+        } else {
+            DispatchQueue.main.async(execute: work)
+        }
+    }
+}
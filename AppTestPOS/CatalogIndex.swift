@@ -0,0 +1,237 @@
+//
+//  CatalogIndex.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import os
+
+/// Read-only product index keyed by the numeric GTIN of `DecodedBarcode.key`.
+///
+/// The snapshot is memory-mapped and used in place: an open-addressing table of 16-byte slots
+/// (key, record offset, record length) followed by the UTF-8 product records. A lookup hashes
+/// the key, probes linearly over adjacent slots and touches the record only on a hit.
+///
+/// Snapshot layout (little endian):
+///
+///     "TBKCAT01" | slot count (UInt32, power of two) | entry count (UInt32)
+///     | records offset (UInt64) | records length (UInt64)
+///     | slots: key (UInt64, 0 = empty), offset (UInt32), length (UInt32)
+///     | records
+final class CatalogIndex {
+
+    static let magic = Array("TBKCAT01".utf8)
+    static let headerSize = 32
+    static let slotSize = 16
+
+    enum SnapshotError: Error {
+        case cannotOpen(Int32)
+        case invalidFormat
+        case checksumMismatch
+    }
+
+    let entryCount: Int
+
+    private let base: UnsafeRawPointer
+    private let mappedLength: Int
+    private let slotCount: Int
+    private let shift: UInt64
+    private let records: UnsafeRawPointer
+    private let recordsLength: Int
+
+    init(contentsOf url: URL) throws {
+        let descriptor = open(url.path, O_RDONLY)
+        guard descriptor >= 0 else {
+            throw SnapshotError.cannotOpen(errno)
+        }
+        defer { close(descriptor) }
+
+        var info = stat()
+        guard fstat(descriptor, &info) == 0, Int(info.st_size) >= CatalogIndex.headerSize else {
+            throw SnapshotError.invalidFormat
+        }
+        let length = Int(info.st_size)
+        let mapped = mmap(nil, length, PROT_READ, MAP_PRIVATE, descriptor, 0)
+        guard let mapping = mapped, mapping != UnsafeMutableRawPointer(bitPattern: -1) else {
+            throw SnapshotError.cannotOpen(errno)
+        }
+        let base = UnsafeRawPointer(mapping)
+
+        let slotCount = Int(base.load(fromByteOffset: 8, as: UInt32.self).littleEndian)
+        let entryCount = Int(base.load(fromByteOffset: 12, as: UInt32.self).littleEndian)
+        let recordsOffset = Int(truncatingIfNeeded: base.load(fromByteOffset: 16, as: UInt64.self).littleEndian)
+        let recordsLength = Int(truncatingIfNeeded: base.load(fromByteOffset: 24, as: UInt64.self).littleEndian)
+
+        let headerMatches = CatalogIndex.magic.indices.allSatisfy { base.load(fromByteOffset: $0, as: UInt8.self) == CatalogIndex.magic[$0] }
+        /* Un snapshot corrupto no debe desbordar la aritmética: se rechaza con invalidFormat */
+        let (slotsSize, slotsOverflow) = slotCount.multipliedReportingOverflow(by: CatalogIndex.slotSize)
+        let (slotsEnd, endOverflow) = slotsSize.addingReportingOverflow(CatalogIndex.headerSize)
+        let (recordsEnd, recordsOverflow) = recordsOffset.addingReportingOverflow(recordsLength)
+        guard headerMatches, slotCount > 0, slotCount & (slotCount - 1) == 0, entryCount < slotCount,
+            !slotsOverflow, !endOverflow, !recordsOverflow,
+            recordsOffset >= slotsEnd, recordsLength >= 0, recordsEnd <= length else {
+            munmap(mapping, length)
+            throw SnapshotError.invalidFormat
+        }
+        madvise(mapping, slotsEnd, MADV_WILLNEED)
+
+        self.base = base
+        self.mappedLength = length
+        self.slotCount = slotCount
+        self.shift = UInt64(64 - slotCount.trailingZeroBitCount)
+        self.entryCount = entryCount
+        self.records = base + recordsOffset
+        self.recordsLength = recordsLength
+    }
+
+    deinit {
+        munmap(UnsafeMutableRawPointer(mutating: base), mappedLength)
+    }
+
+    /// Returns the product record stored for `key`, or `nil` when the code is not in the catalog.
+    func lookup(_ key: UInt64) -> String? {
+        guard let (offset, length) = find(key) else {
+            return nil
+        }
+        return String(decoding: UnsafeRawBufferPointer(start: records + offset, count: length), as: UTF8.self)
+    }
+
+    func contains(_ key: UInt64) -> Bool {
+        return find(key) != nil
+    }
+
+    private func find(_ key: UInt64) -> (Int, Int)? {
+        guard key != 0 else {
+            return nil
+        }
+        let mask = slotCount - 1
+        var index = CatalogIndex.slot(for: key, shift: shift)
+        let slots = base + CatalogIndex.headerSize
+        for _ in 0..<slotCount {
+            let slot = slots + index * CatalogIndex.slotSize
+            let stored = slot.load(as: UInt64.self).littleEndian
+            if stored == key {
+                let offset = Int(slot.load(fromByteOffset: 8, as: UInt32.self).littleEndian)
+                let length = Int(slot.load(fromByteOffset: 12, as: UInt32.self).littleEndian)
+                return offset + length <= recordsLength ? (offset, length) : nil
+            }
+            if stored == 0 {
+                return nil
+            }
+            index = (index + 1) & mask
+        }
+        return nil
+    }
+
+    private static func slot(for key: UInt64, shift: UInt64) -> Int {
+        if shift >= 64 {
+            return 0
+        }
+        return Int(truncatingIfNeeded: (key &* 0x9E3779B97F4A7C15) >> shift)
+    }
+
+    /// Builds a snapshot for `entries` (GTIN key, product record) at a 0.7 load factor.
+    static func snapshot(_ entries: [(key: UInt64, record: String)]) -> Data {
+        var slotCount = 1
+        while slotCount * 7 < entries.count * 10 + 7 {
+            slotCount <<= 1
+        }
+        let shift = UInt64(64 - slotCount.trailingZeroBitCount)
+        let mask = slotCount - 1
+
+        var slots = [UInt64](repeating: 0, count: slotCount * 2)
+        var records = Data()
+        var stored = 0
+        for entry in entries where entry.key != 0 {
+            var index = slot(for: entry.key, shift: shift)
+            while slots[index * 2] != 0 && slots[index * 2] != entry.key {
+                index = (index + 1) & mask
+            }
+            if slots[index * 2] == 0 {
+                stored += 1
+            }
+            let bytes = Data(entry.record.utf8)
+            slots[index * 2] = entry.key
+            slots[index * 2 + 1] = UInt64(records.count) | UInt64(bytes.count) << 32
+            records.append(bytes)
+        }
+
+        let recordsOffset = headerSize + slotCount * slotSize
+        var data = Data(capacity: recordsOffset + records.count)
+        data.append(contentsOf: magic)
+        append(UInt32(slotCount), to: &data)
+        append(UInt32(stored), to: &data)
+        append(UInt64(recordsOffset), to: &data)
+        append(UInt64(records.count), to: &data)
+        for index in 0..<slotCount {
+            append(slots[index * 2], to: &data)
+            append(UInt32(truncatingIfNeeded: slots[index * 2 + 1]), to: &data)
+            append(UInt32(truncatingIfNeeded: slots[index * 2 + 1] >> 32), to: &data)
+        }
+        data.append(records)
+        return data
+    }
+
+    private static func append<T: FixedWidthInteger>(_ value: T, to data: inout Data) {
+        var littleEndian = value.littleEndian
+        withUnsafeBytes(of: &littleEndian) { data.append(contentsOf: $0) }
+    }
+}
+
+/*Mantiene el índice vigente; un nuevo snapshot reemplaza al anterior sin bloquear las búsquedas en curso*/
+final class CatalogStore {
+
+    private var current: CatalogIndex?
+    private let lock: os_unfair_lock_t = {
+        let lock = os_unfair_lock_t.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+
+    deinit {
+        lock.deinitialize(count: 1)
+        lock.deallocate()
+    }
+
+    /// Snapshot location in Application Support; written by `update(_:at:)` from the product feed.
+    static func defaultURL() -> URL {
+        let directory = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask)[0]
+        return directory.appendingPathComponent("catalog.bin")
+    }
+
+    var index: CatalogIndex? {
+        os_unfair_lock_lock(lock)
+        defer { os_unfair_lock_unlock(lock) }
+        return current
+    }
+
+    func lookup(_ barcode: DecodedBarcode) -> String? {
+        guard let key = barcode.key else {
+            return nil
+        }
+        return index?.lookup(key)
+    }
+
+    /// Maps the snapshot at `url` and publishes it; lookups already running keep the old mapping
+    /// alive until they finish. With `crc32c` the file is checked against it first.
+    func load(contentsOf url: URL, crc32c expected: UInt32? = nil) throws {
+        if let expected = expected, Checksum.crc32c(contentsOf: url) != expected {
+            throw CatalogIndex.SnapshotError.checksumMismatch
+        }
+        let index = try CatalogIndex(contentsOf: url)
+        os_unfair_lock_lock(lock)
+        current = index
+        os_unfair_lock_unlock(lock)
+    }
+
+    /// Writes `entries` as a new snapshot next to `url`, renames it into place and publishes it
+    /// once the file on disk reads back with the snapshot's CRC32C.
+    func update(_ entries: [(key: UInt64, record: String)], at url: URL) throws {
+        let snapshot = CatalogIndex.snapshot(entries)
+        try snapshot.write(to: url, options: .atomic)
+        try load(contentsOf: url, crc32c: Checksum.crc32c(snapshot))
+    }
+}
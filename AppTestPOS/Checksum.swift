@@ -0,0 +1,226 @@
+//
+//  Checksum.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// LRC, CRC16 and CRC32C kernels.
+///
+/// `lrc` picks its kernel by length: byte by byte for short inputs, 64-bit words once there is
+/// a word to align to, and 16-byte vectors for long buffers such as file chunks. Every kernel
+/// returns the same value; only the cost differs.
+enum Checksum {
+
+    static let wordThreshold = 16
+    static let vectorThreshold = 128
+
+    // MARK: - LRC
+
+    static func lrc(_ bytes: UnsafeRawBufferPointer) -> UInt8 {
+        switch bytes.count {
+        case ..<wordThreshold:
+            return lrcBytes(bytes)
+        case ..<vectorThreshold:
+            return lrcWords(bytes)
+        default:
+            return lrcVectors(bytes)
+        }
+    }
+
+    static func lrc(_ data: Data) -> UInt8 {
+        return data.withUnsafeBytes { lrc($0) }
+    }
+
+    static func lrcBytes(_ bytes: UnsafeRawBufferPointer) -> UInt8 {
+        var lrc: UInt8 = 0
+        for byte in bytes {
+            lrc ^= byte
+        }
+        return lrc
+    }
+
+    /// XOR of aligned 64-bit words, folded down to one byte; the unaligned head and tail go byte by byte.
+    static func lrcWords(_ bytes: UnsafeRawBufferPointer) -> UInt8 {
+        guard let base = bytes.baseAddress else {
+            return 0
+        }
+        let head = min(bytes.count, (8 - Int(bitPattern: base) & 7) & 7)
+        var lrc = lrcBytes(UnsafeRawBufferPointer(rebasing: bytes[0..<head]))
+        var word: UInt64 = 0
+        var offset = head
+        while offset + 8 <= bytes.count {
+            word ^= base.load(fromByteOffset: offset, as: UInt64.self)
+            offset += 8
+        }
+        lrc ^= fold(word)
+        return lrc ^ lrcBytes(UnsafeRawBufferPointer(rebasing: bytes[offset...]))
+    }
+
+    /// XOR of aligned 16-byte vectors, four at a time.
+    static func lrcVectors(_ bytes: UnsafeRawBufferPointer) -> UInt8 {
+        guard let base = bytes.baseAddress else {
+            return 0
+        }
+        let head = min(bytes.count, (16 - Int(bitPattern: base) & 15) & 15)
+        var lrc = lrcBytes(UnsafeRawBufferPointer(rebasing: bytes[0..<head]))
+        var a = SIMD16<UInt8>(repeating: 0)
+        var b = a
+        var c = a
+        var d = a
+        var offset = head
+        while offset + 64 <= bytes.count {
+            a ^= base.load(fromByteOffset: offset, as: SIMD16<UInt8>.self)
+            b ^= base.load(fromByteOffset: offset + 16, as: SIMD16<UInt8>.self)
+            c ^= base.load(fromByteOffset: offset + 32, as: SIMD16<UInt8>.self)
+            d ^= base.load(fromByteOffset: offset + 48, as: SIMD16<UInt8>.self)
+            offset += 64
+        }
+        let vector = a ^ b ^ c ^ d
+        let halves = unsafeBitCast(vector, to: (UInt64, UInt64).self)
+        lrc ^= fold(halves.0 ^ halves.1)
+        return lrc ^ lrcWords(UnsafeRawBufferPointer(rebasing: bytes[offset...]))
+    }
+
+    private static func fold(_ word: UInt64) -> UInt8 {
+        var x = word
+        x ^= x >> 32
+        x ^= x >> 16
+        x ^= x >> 8
+        return UInt8(truncatingIfNeeded: x)
+    }
+
+    // MARK: - CRC16
+
+    enum CRC16: CaseIterable {
+        /// Poly 0x1021, init 0xFFFF (CRC-16/CCITT-FALSE).
+        case ccittFalse
+        /// Poly 0x1021, init 0 (CRC-16/XMODEM).
+        case xmodem
+        /// Poly 0x8005 reflected, init 0 (CRC-16/ARC).
+        case arc
+
+        fileprivate var initial: UInt16 {
+            return self == .ccittFalse ? 0xFFFF : 0
+        }
+
+        fileprivate var table: [UInt16] {
+            switch self {
+            case .ccittFalse, .xmodem:
+                return Checksum.crc16CCITTTable
+            case .arc:
+                return Checksum.crc16ARCTable
+            }
+        }
+    }
+
+    private static let crc16CCITTTable: [UInt16] = (0..<256).map { index -> UInt16 in
+        var crc = UInt16(index) << 8
+        for _ in 0..<8 {
+            crc = crc & 0x8000 != 0 ? crc << 1 ^ 0x1021 : crc << 1
+        }
+        return crc
+    }
+
+    private static let crc16ARCTable: [UInt16] = (0..<256).map { index -> UInt16 in
+        var crc = UInt16(index)
+        for _ in 0..<8 {
+            crc = crc & 1 != 0 ? crc >> 1 ^ 0xA001 : crc >> 1
+        }
+        return crc
+    }
+
+    static func crc16(_ bytes: UnsafeRawBufferPointer, _ variant: CRC16, seed: UInt16? = nil) -> UInt16 {
+        var crc = seed ?? variant.initial
+        variant.table.withUnsafeBufferPointer { table in
+            switch variant {
+            case .ccittFalse, .xmodem:
+                for byte in bytes {
+                    crc = crc << 8 ^ table[Int(UInt8(truncatingIfNeeded: crc >> 8) ^ byte)]
+                }
+            case .arc:
+                for byte in bytes {
+                    crc = crc >> 8 ^ table[Int(UInt8(truncatingIfNeeded: crc) ^ byte)]
+                }
+            }
+        }
+        return crc
+    }
+
+    static func crc16(_ data: Data, _ variant: CRC16) -> UInt16 {
+        return data.withUnsafeBytes { crc16($0, variant) }
+    }
+
+    // MARK: - CRC32C
+
+    /// Slice-by-8 tables for the Castagnoli polynomial (reflected 0x82F63B78).
+    private static let crc32cTables: [UInt32] = {
+        var tables = [UInt32](repeating: 0, count: 8 * 256)
+        for index in 0..<256 {
+            var crc = UInt32(index)
+            for _ in 0..<8 {
+                crc = crc & 1 != 0 ? crc >> 1 ^ 0x82F6_3B78 : crc >> 1
+            }
+            tables[index] = crc
+        }
+        for index in 0..<256 {
+            var crc = tables[index]
+            for slice in 1..<8 {
+                crc = crc >> 8 ^ tables[Int(crc & 0xFF)]
+                tables[slice * 256 + index] = crc
+            }
+        }
+        return tables
+    }()
+
+    /// CRC32C of `bytes`; pass the previous result as `crc` to continue over the next chunk.
+    static func crc32c(_ bytes: UnsafeRawBufferPointer, continuing crc: UInt32 = 0) -> UInt32 {
+        guard let base = bytes.baseAddress else {
+            return crc
+        }
+        var value = ~crc
+        crc32cTables.withUnsafeBufferPointer { t in
+            var offset = 0
+            while offset < bytes.count && (Int(bitPattern: base) + offset) & 7 != 0 {
+                value = value >> 8 ^ t[Int((value ^ UInt32(bytes[offset])) & 0xFF)]
+                offset += 1
+            }
+            while offset + 8 <= bytes.count {
+                let word = UInt64(littleEndian: base.load(fromByteOffset: offset, as: UInt64.self)) ^ UInt64(value)
+                value = t[7 * 256 + Int(word & 0xFF)] ^ t[6 * 256 + Int(word >> 8 & 0xFF)]
+                    ^ t[5 * 256 + Int(word >> 16 & 0xFF)] ^ t[4 * 256 + Int(word >> 24 & 0xFF)]
+                    ^ t[3 * 256 + Int(word >> 32 & 0xFF)] ^ t[2 * 256 + Int(word >> 40 & 0xFF)]
+                    ^ t[1 * 256 + Int(word >> 48 & 0xFF)] ^ t[Int(word >> 56)]
+                offset += 8
+            }
+            while offset < bytes.count {
+                value = value >> 8 ^ t[Int((value ^ UInt32(bytes[offset])) & 0xFF)]
+                offset += 1
+            }
+        }
+        return ~value
+    }
+
+    static func crc32c(_ data: Data, continuing crc: UInt32 = 0) -> UInt32 {
+        return data.withUnsafeBytes { crc32c($0, continuing: crc) }
+    }
+
+    /// CRC32C of a file, read in `chunkSize` chunks; `nil` if it cannot be read.
+    static func crc32c(contentsOf url: URL, chunkSize: Int = 64 * 1024) -> UInt32? {
+        guard let handle = try? FileHandle(forReadingFrom: url) else {
+            return nil
+        }
+        defer { handle.closeFile() }
+        var crc: UInt32 = 0
+        while true {
+            let chunk = handle.readData(ofLength: chunkSize)
+            if chunk.isEmpty {
+                return crc
+            }
+            crc = crc32c(chunk, continuing: crc)
+        }
+    }
+}
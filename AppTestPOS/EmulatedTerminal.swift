@@ -0,0 +1,229 @@
+//
+//  EmulatedTerminal.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+#if DEBUG
+import Foundation
+import Network
+
+/// In-process terminal that speaks the framed protocol, for benchmarks and link simulations.
+///
+/// It ACKs each valid frame, NAKs corrupted ones, answers every command code with a canned
+/// response after `latency`, and retransmits its last frame when the host NAKs it.
+final class EmulatedTerminalLink: PosLink {
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+    let acknowledgesFrames = true
+
+    var latency: TimeInterval
+    /// Records returned for 0260 before the end-of-stream record.
+    var detailCount: Int
+
+    let terminalId: String
+    private let queue: DispatchQueue
+    private let parser = PosFrameParser()
+    private var lastFrame: Data?
+    private var operationNumber = 0
+    private var salesCount = 0
+    private var salesTotal = 0
+
+    init(terminalId: String = "12345678", latency: TimeInterval = 0, detailCount: Int = 20) {
+        self.terminalId = terminalId
+        self.latency = latency
+        self.detailCount = detailCount
+        self.queue = DispatchQueue(label: "cl.transbank.emulated-terminal.\(terminalId)")
+    }
+
+    func send(_ bytes: Data) {
+        queue.async {
+            for event in self.parser.feed(bytes) {
+                switch event {
+                case .ack:
+                    break
+                case .nak:
+                    if let frame = self.lastFrame {
+                        self.deliver(frame)
+                    }
+                case .corrupted:
+                    self.deliver(Data([PosFrame.NAK]))
+                case .frame(let command):
+                    self.deliver(Data([PosFrame.ACK]))
+                    let responses = self.respond(to: command)
+                    self.queue.asyncAfter(deadline: .now() + self.latency) {
+                        for response in responses {
+                            let frame = PosFrame.encode(response)
+                            self.lastFrame = frame
+                            self.deliver(frame)
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /// Drops the connection as a Bluetooth link would.
+    func disconnect() {
+        queue.async {
+            self.parser.reset()
+            self.onDisconnect?()
+        }
+    }
+
+    private func deliver(_ bytes: Data) {
+        onReceive?(bytes)
+    }
+
+    private func respond(to command: PosResponse) -> [String] {
+        let commerce = "597029414300"
+        switch command.code {
+        case "0200":
+            let amount = command.integer(1) ?? 0
+            operationNumber += 1
+            salesCount += 1
+            salesTotal += amount
+            return ["0210|00|\(commerce)|\(terminalId)|\(command.field(2) ?? "")|\(String(format: "%06d", operationNumber))|\(amount)|0|0|6543|\(operationNumber)|CR|1810|123456|VI|18102026|120000|0|0"]
+        case "0250":
+            return ["0250|00|\(commerce)|\(terminalId)|123456|\(String(format: "%06d", operationNumber))|1000|0|0|6543|\(operationNumber)|CR|1810|123456|VI|18102026|120000|0|0"]
+        case "0260":
+            var records = (0..<detailCount).map { index in
+                "0260|00|\(commerce)|\(terminalId)|\(index)|\(String(format: "%06d", index + 1))|\(1000 + index)|6543|\(index + 1)|CR|1810|123456|VI|18102026|120000|0|0|0|0"
+            }
+            records.append("0260|00|\(commerce)|\(terminalId)||||||||||||||||")
+            return records
+        case "0500":
+            salesCount = 0
+            salesTotal = 0
+            return ["0510|00|\(commerce)|\(terminalId)"]
+        case "0700":
+            return ["0710|00|\(salesCount)|\(salesTotal)"]
+        case "0800":
+            return ["0810|00|\(commerce)|\(terminalId)"]
+        case "1200":
+            return ["1210|00|\(commerce)|\(terminalId)|000001|\(command.integer(1) ?? 0)"]
+        default:
+            return []
+        }
+    }
+}
+
+/// An `EmulatedTerminalLink` served on a pty, so the serial transport can be exercised end to
+/// end without hardware (e.g. in CI): open a `SerialPortLink` on `slavePath`.
+final class PseudoTerminalEmulator {
+
+    let emulator: EmulatedTerminalLink
+    let slavePath: String
+    private let port: SerialPortLink
+    /* Un descriptor del esclavo abierto evita EIO en el maestro mientras no hay cliente */
+    private let keepAlive: Int32
+
+    init(emulator: EmulatedTerminalLink = EmulatedTerminalLink()) throws {
+        let (master, slavePath) = try SerialPortLink.openPseudoTerminal()
+        self.emulator = emulator
+        self.slavePath = slavePath
+        self.keepAlive = open(slavePath, O_RDWR | O_NOCTTY | O_NONBLOCK)
+        self.port = SerialPortLink(fileDescriptor: master, name: "emulator")
+
+        let ring = port.ring
+        port.deliver(on: DispatchQueue(label: "cl.transbank.emulated-terminal.pty")) {
+            ring.drain { emulator.send(Data($0)) }
+        }
+        emulator.onReceive = { [weak port] bytes in
+            port?.send(bytes)
+        }
+    }
+
+    deinit {
+        if keepAlive >= 0 {
+            close(keepAlive)
+        }
+    }
+}
+
+/// Local TCP stand-in for an IP terminal: every accepted connection gets its own
+/// `EmulatedTerminalLink`. With `tls`, the listener presents that identity, so `TCPLink` can be
+/// exercised with TLS (and session resumption) against it.
+@available(iOS 12.0, *)
+final class EmulatedTerminalListener {
+
+    private let listener: NWListener
+    private let queue = DispatchQueue(label: "cl.transbank.emulated-terminal.tcp")
+    private var terminals: [ObjectIdentifier: EmulatedTerminalLink] = [:]
+
+    var port: UInt16? {
+        return listener.port?.rawValue
+    }
+
+    init(tls identity: SecIdentity? = nil) throws {
+        let tcp = NWProtocolTCP.Options()
+        tcp.noDelay = true
+        var tlsOptions: NWProtocolTLS.Options?
+        if let identity = identity, let local = sec_identity_create(identity) {
+            let options = NWProtocolTLS.Options()
+            sec_protocol_options_set_local_identity(options.securityProtocolOptions, local)
+            sec_protocol_options_set_tls_tickets_enabled(options.securityProtocolOptions, true)
+            tlsOptions = options
+        }
+        let parameters = NWParameters(tls: tlsOptions, tcp: tcp)
+        parameters.requiredLocalEndpoint = .hostPort(host: "127.0.0.1", port: .any)
+        listener = try NWListener(using: parameters)
+        listener.newConnectionHandler = { [weak self] connection in
+            self?.accept(connection)
+        }
+    }
+
+    deinit {
+        listener.cancel()
+    }
+
+    /// Starts listening and waits until the port is known.
+    func start() -> Bool {
+        let ready = DispatchSemaphore(value: 0)
+        listener.stateUpdateHandler = { state in
+            switch state {
+            case .ready, .failed, .cancelled:
+                ready.signal()
+            default:
+                break
+            }
+        }
+        listener.start(queue: queue)
+        return ready.wait(timeout: .now() + 5) == .success && port != nil
+    }
+
+    private func accept(_ connection: NWConnection) {
+        let terminal = EmulatedTerminalLink()
+        let key = ObjectIdentifier(connection)
+        terminals[key] = terminal
+        terminal.onReceive = { bytes in
+            connection.send(content: bytes, completion: .contentProcessed { _ in })
+        }
+        connection.stateUpdateHandler = { [weak self] state in
+            switch state {
+            case .failed, .cancelled:
+                self?.queue.async { self?.terminals[key] = nil }
+            default:
+                break
+            }
+        }
+        func receive() {
+            connection.receive(minimumIncompleteLength: 1, maximumLength: 64 * 1024) { data, _, isComplete, error in
+                if let data = data, !data.isEmpty {
+                    terminal.send(data)
+                }
+                if isComplete || error != nil {
+                    connection.cancel()
+                } else {
+                    receive()
+                }
+            }
+        }
+        receive()
+        connection.start(queue: queue)
+    }
+}
+#endif
@@ -0,0 +1,502 @@
+//
+//  EscPosPrinter.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import UIKit
+import Network
+
+/*Destino de los bytes ESC/POS: impresora de red, puente USB o la impresora de prueba*/
+protocol EscPosSink: AnyObject {
+    func write(_ data: Data)
+    /// Called when the printer may have lost its state (connection dropped, power cycle).
+    var onPrinterReset: (() -> Void)? { get set }
+}
+
+/// Turns the `shouldPrint*` callback stream of the terminal into ESC/POS commands.
+///
+/// Consecutive text lines are coalesced into a single write and style commands are only
+/// emitted when the style actually changes. Images are converted once to a 1-bit raster,
+/// stored in the printer as download graphics and printed by key on later receipts. Download
+/// graphics live in the printer's RAM, so the cache is dropped whenever the sink reports a reset.
+final class EscPosReceiptPrinter {
+
+    struct TextStyle: Equatable {
+        var alignment: NSTextAlignment = .left
+        var xScale = 1
+        var yScale = 1
+        var underline = false
+        var bold = false
+    }
+
+    let sink: EscPosSink
+    let maxDots: Int
+
+    private let queue = DispatchQueue(label: "cl.transbank.escpos")
+    private var pending = Data()
+    private var printerStyle = TextStyle()
+    private var needsInitialize = true
+    private var graphics = EscPosGraphicsCache(capacity: 32)
+    private var idleFlush: DispatchWorkItem?
+
+    private static let flushThreshold = 4096
+    private static let idleFlushDelay = DispatchTimeInterval.milliseconds(50)
+
+    /// - Parameter maxDots: printable width in dots (576 for 80mm paper, 384 for 58mm).
+    init(sink: EscPosSink, maxDots: Int = 576) {
+        self.sink = sink
+        self.maxDots = maxDots
+        sink.onPrinterReset = { [weak self] in
+            self?.printerDidReset()
+        }
+    }
+
+    func printText(_ text: String, style: TextStyle) {
+        queue.async {
+            self.apply(style)
+            self.pending.append(EscPosCommand.encode(text))
+            self.pending.append(EscPosCommand.lineFeed)
+            self.scheduleFlush()
+        }
+    }
+
+    func printRawText(_ bytes: Data, style: TextStyle) {
+        queue.async {
+            self.apply(style)
+            self.pending.append(bytes)
+            self.pending.append(EscPosCommand.lineFeed)
+            self.scheduleFlush()
+        }
+    }
+
+    func printImage(_ image: UIImage, alignment: NSTextAlignment = .center) {
+        queue.async {
+            guard let raster = EscPosRaster(image: image, maxDots: self.maxDots) else {
+                return
+            }
+            var style = self.printerStyle
+            style.alignment = alignment
+            self.apply(style)
+
+            let (key, stored) = self.graphics.key(for: raster.fingerprint)
+            if !stored {
+                if let evicted = key.evicted {
+                    self.pending.append(EscPosCommand.deleteGraphics(key: evicted))
+                }
+                self.pending.append(EscPosCommand.storeGraphics(raster, key: key.code))
+            }
+            self.pending.append(EscPosCommand.printGraphics(key: key.code))
+            self.flush()
+        }
+    }
+
+    func feed(lines: Int) {
+        queue.async {
+            self.prepare()
+            self.pending.append(EscPosCommand.feed(lines: lines))
+            self.scheduleFlush()
+        }
+    }
+
+    func cut() {
+        queue.async {
+            self.prepare()
+            self.pending.append(EscPosCommand.cut)
+            self.flush()
+        }
+    }
+
+    func endReceipt() {
+        queue.async {
+            self.flush()
+        }
+    }
+
+    /// Blocks until every callback received so far has been written to the sink.
+    func synchronize() {
+        queue.sync {}
+    }
+
+    /* La impresora reinició: no conserva los gráficos guardados ni el estilo */
+    private func printerDidReset() {
+        queue.async {
+            self.graphics = EscPosGraphicsCache(capacity: 32)
+            self.needsInitialize = true
+        }
+    }
+
+    private func prepare() {
+        if needsInitialize {
+            pending.append(EscPosCommand.initialize)
+            printerStyle = TextStyle()
+            needsInitialize = false
+        }
+    }
+
+    private func apply(_ style: TextStyle) {
+        prepare()
+        if style.alignment != printerStyle.alignment {
+            pending.append(EscPosCommand.align(style.alignment))
+        }
+        if style.xScale != printerStyle.xScale || style.yScale != printerStyle.yScale {
+            pending.append(EscPosCommand.size(x: style.xScale, y: style.yScale))
+        }
+        if style.underline != printerStyle.underline {
+            pending.append(EscPosCommand.underline(style.underline))
+        }
+        if style.bold != printerStyle.bold {
+            pending.append(EscPosCommand.bold(style.bold))
+        }
+        printerStyle = style
+    }
+
+    private func scheduleFlush() {
+        if pending.count >= EscPosReceiptPrinter.flushThreshold {
+            flush()
+            return
+        }
+        if idleFlush == nil {
+            let item = DispatchWorkItem { [weak self] in self?.flush() }
+            idleFlush = item
+            queue.asyncAfter(deadline: .now() + EscPosReceiptPrinter.idleFlushDelay, execute: item)
+        }
+    }
+
+    private func flush() {
+        idleFlush?.cancel()
+        idleFlush = nil
+        guard !pending.isEmpty else {
+            return
+        }
+        sink.write(pending)
+        pending = Data()
+    }
+}
+
+enum EscPosCommand {
+    static let ESC: UInt8 = 0x1B
+    static let GS: UInt8 = 0x1D
+
+    /* ESC @ reinicia la impresora y ESC t 16 selecciona la tabla WPC1252 (acentos y ñ) */
+    static let initialize = Data([ESC, 0x40, ESC, 0x74, 16])
+    static let lineFeed = Data([0x0A])
+    static let cut = Data([GS, 0x56, 66, 0])
+
+    static func encode(_ text: String) -> Data {
+        return text.data(using: .windowsCP1252, allowLossyConversion: true) ?? Data()
+    }
+
+    static func align(_ alignment: NSTextAlignment) -> Data {
+        switch alignment {
+        case .center: return Data([ESC, 0x61, 1])
+        case .right: return Data([ESC, 0x61, 2])
+        default: return Data([ESC, 0x61, 0])
+        }
+    }
+
+    static func size(x: Int, y: Int) -> Data {
+        let width = UInt8(min(max(x, 1), 8) - 1)
+        let height = UInt8(min(max(y, 1), 8) - 1)
+        return Data([GS, 0x21, width << 4 | height])
+    }
+
+    static func underline(_ enabled: Bool) -> Data {
+        return Data([ESC, 0x2D, enabled ? 1 : 0])
+    }
+
+    static func bold(_ enabled: Bool) -> Data {
+        return Data([ESC, 0x45, enabled ? 1 : 0])
+    }
+
+    static func feed(lines: Int) -> Data {
+        return Data([ESC, 0x64, UInt8(min(max(lines, 0), 255))])
+    }
+
+    /* GS 8 L <p1..p4> 48 83: guarda un raster como download graphics con la llave kc1 kc2 */
+    static func storeGraphics(_ raster: EscPosRaster, key: (UInt8, UInt8)) -> Data {
+        let parameters = 11 + raster.bits.count
+        var data = Data(capacity: 7 + parameters)
+        data.append(contentsOf: [GS, 0x38, 0x4C])
+        data.append(contentsOf: [UInt8(parameters & 0xFF), UInt8((parameters >> 8) & 0xFF),
+                                 UInt8((parameters >> 16) & 0xFF), UInt8((parameters >> 24) & 0xFF)])
+        data.append(contentsOf: [48, 83, 48, key.0, key.1, 1,
+                                 UInt8(raster.width & 0xFF), UInt8(raster.width >> 8),
+                                 UInt8(raster.height & 0xFF), UInt8(raster.height >> 8), 49])
+        data.append(raster.bits)
+        return data
+    }
+
+    /* GS ( L 48 85: imprime el download graphics guardado con la llave kc1 kc2 */
+    static func printGraphics(key: (UInt8, UInt8)) -> Data {
+        return Data([GS, 0x28, 0x4C, 6, 0, 48, 85, key.0, key.1, 1, 1])
+    }
+
+    /* GS ( L 48 82: borra el download graphics guardado con la llave kc1 kc2 */
+    static func deleteGraphics(key: (UInt8, UInt8)) -> Data {
+        return Data([GS, 0x28, 0x4C, 4, 0, 48, 82, key.0, key.1])
+    }
+}
+
+/// A 1-bit, row-major raster of an image, MSB first, ready for ESC/POS graphics commands.
+struct EscPosRaster {
+    let width: Int
+    let height: Int
+    let bits: Data
+    let fingerprint: UInt64
+
+    init?(image: UIImage, maxDots: Int) {
+        guard let cgImage = image.cgImage, cgImage.width > 0, cgImage.height > 0 else {
+            return nil
+        }
+        let scale = min(1.0, Double(maxDots) / Double(cgImage.width))
+        let width = max(1, Int(Double(cgImage.width) * scale))
+        let height = max(1, Int(Double(cgImage.height) * scale))
+
+        var gray = [UInt8](repeating: 0xFF, count: width * height)
+        let drawn: Bool = gray.withUnsafeMutableBytes { buffer in
+            guard let context = CGContext(data: buffer.baseAddress, width: width, height: height,
+                                          bitsPerComponent: 8, bytesPerRow: width,
+                                          space: CGColorSpaceCreateDeviceGray(),
+                                          bitmapInfo: CGImageAlphaInfo.none.rawValue) else {
+                return false
+            }
+            context.setFillColor(gray: 1, alpha: 1)
+            context.fill(CGRect(x: 0, y: 0, width: width, height: height))
+            context.draw(cgImage, in: CGRect(x: 0, y: 0, width: width, height: height))
+            return true
+        }
+        if !drawn {
+            return nil
+        }
+
+        let bytesPerRow = (width + 7) / 8
+        var bits = [UInt8](repeating: 0, count: bytesPerRow * height)
+        var hash: UInt64 = 0xcbf29ce484222325 ^ UInt64(width) << 32 ^ UInt64(height)
+        for y in 0..<height {
+            let row = y * width
+            for x in 0..<width where gray[row + x] < 0x80 {
+                bits[y * bytesPerRow + x >> 3] |= 0x80 >> UInt8(x & 7)
+            }
+            for byte in bits[(y * bytesPerRow)..<((y + 1) * bytesPerRow)] {
+                hash = (hash ^ UInt64(byte)) &* 0x100000001b3
+            }
+        }
+
+        self.width = width
+        self.height = height
+        self.bits = Data(bits)
+        self.fingerprint = hash
+    }
+}
+
+/*Asigna llaves de download graphics a los raster ya enviados a la impresora (LRU)*/
+struct EscPosGraphicsCache {
+    struct Key {
+        let code: (UInt8, UInt8)
+        let evicted: (UInt8, UInt8)?
+    }
+
+    private let capacity: Int
+    private var slots: [UInt64] = []
+    private var lastUse: [Int] = []
+    private var clock = 0
+
+    init(capacity: Int) {
+        self.capacity = min(capacity, 94)
+    }
+
+    /// Returns the key for `fingerprint` and whether the graphic is already stored in the printer.
+    mutating func key(for fingerprint: UInt64) -> (Key, Bool) {
+        clock += 1
+        if let index = slots.firstIndex(of: fingerprint) {
+            lastUse[index] = clock
+            return (Key(code: EscPosGraphicsCache.code(index), evicted: nil), true)
+        }
+        if slots.count < capacity {
+            slots.append(fingerprint)
+            lastUse.append(clock)
+            return (Key(code: EscPosGraphicsCache.code(slots.count - 1), evicted: nil), false)
+        }
+        let index = lastUse.indices.min { lastUse[$0] < lastUse[$1] } ?? 0
+        slots[index] = fingerprint
+        lastUse[index] = clock
+        let code = EscPosGraphicsCache.code(index)
+        return (Key(code: code, evicted: code), false)
+    }
+
+    private static func code(_ index: Int) -> (UInt8, UInt8) {
+        return (0x54, UInt8(0x21 + index))
+    }
+}
+
+/// Network printer sink (raw TCP, usually port 9100).
+///
+/// Writes are pipelined: every chunk is handed to the connection immediately and only the
+/// amount of unacknowledged bytes is tracked, so the encoder never waits on the printer. A
+/// printer that is switched off drops the connection; it is reported as a reset and the next
+/// write opens a new one.
+@available(iOS 12.0, *)
+final class EscPosNetworkSink: EscPosSink {
+    var onPrinterReset: (() -> Void)?
+
+    private let host: NWEndpoint.Host
+    private let port: NWEndpoint.Port
+    private var connection: NWConnection?
+    private let queue = DispatchQueue(label: "cl.transbank.escpos.network")
+    private var inFlight = 0
+
+    /// Bytes queued in the connection that the printer has not consumed yet.
+    var bytesInFlight: Int {
+        return queue.sync { inFlight }
+    }
+
+    init(host: String, port: UInt16 = 9100) {
+        self.host = NWEndpoint.Host(host)
+        self.port = NWEndpoint.Port(rawValue: port) ?? 9100
+        queue.async {
+            _ = self.connect()
+        }
+    }
+
+    deinit {
+        connection?.stateUpdateHandler = nil
+        connection?.cancel()
+    }
+
+    func write(_ data: Data) {
+        queue.async {
+            let connection = self.connection ?? self.connect()
+            self.inFlight += data.count
+            connection.send(content: data, completion: .contentProcessed { error in
+                self.inFlight -= data.count
+                if let error = error {
+                    print("ESC/POS write failed: \(error)")
+                }
+            })
+        }
+    }
+
+    private func connect() -> NWConnection {
+        let tcp = NWProtocolTCP.Options()
+        tcp.noDelay = true
+        tcp.enableKeepalive = true
+        let connection = NWConnection(host: host, port: port, using: NWParameters(tls: nil, tcp: tcp))
+        connection.stateUpdateHandler = { [weak self, weak connection] state in
+            guard let self = self, let connection = connection, connection === self.connection else {
+                return
+            }
+            switch state {
+            case .failed, .cancelled:
+                connection.stateUpdateHandler = nil
+                self.connection = nil
+                self.onPrinterReset?()
+            default:
+                break
+            }
+        }
+        self.connection = connection
+        connection.start(queue: queue)
+        return connection
+    }
+}
+
+/*Impresora local de prueba: guarda lo recibido y lo interpreta para poder revisarlo*/
+final class EscPosMockPrinter: EscPosSink {
+    enum Operation: Equatable {
+        case initialize
+        case text(String)
+        case style(String)
+        case storeGraphics(key: UInt8, width: Int, height: Int)
+        case printGraphics(key: UInt8)
+        case deleteGraphics(key: UInt8)
+        case feed(Int)
+        case cut
+    }
+
+    var onPrinterReset: (() -> Void)?
+
+    private let lock = NSLock()
+    private var received = Data()
+    private(set) var writes = 0
+
+    /// Simulates switching the printer off and on: the received bytes stay, the printer state does not.
+    func powerCycle() {
+        onPrinterReset?()
+    }
+
+    var bytes: Data {
+        lock.lock()
+        defer { lock.unlock() }
+        return received
+    }
+
+    func write(_ data: Data) {
+        lock.lock()
+        received.append(data)
+        writes += 1
+        lock.unlock()
+    }
+
+    /// Decodes the received byte stream back into printer operations.
+    func operations() -> [Operation] {
+        let data = [UInt8](bytes)
+        var result: [Operation] = []
+        var text = [UInt8]()
+        var i = 0
+
+        func flushText() {
+            if !text.isEmpty {
+                result.append(.text(String(data: Data(text), encoding: .windowsCP1252) ?? ""))
+                text.removeAll()
+            }
+        }
+
+        while i < data.count {
+            let byte = data[i]
+            if byte == EscPosCommand.ESC, i + 1 < data.count {
+                flushText()
+                switch data[i + 1] {
+                case 0x40: result.append(.initialize); i += 2
+                case 0x74: i += 3
+                case 0x64: result.append(.feed(Int(data[min(i + 2, data.count - 1)]))); i += 3
+                default: result.append(.style(String(format: "ESC %02X", data[i + 1]))); i += 3
+                }
+            } else if byte == EscPosCommand.GS, i + 1 < data.count {
+                flushText()
+                switch data[i + 1] {
+                case 0x56:
+                    result.append(.cut); i += 4
+                case 0x21:
+                    result.append(.style("GS 21")); i += 3
+                case 0x38 where i + 17 <= data.count:
+                    let p = Int(data[i + 3]) | Int(data[i + 4]) << 8 | Int(data[i + 5]) << 16 | Int(data[i + 6]) << 24
+                    let width = Int(data[i + 13]) | Int(data[i + 14]) << 8
+                    let height = Int(data[i + 15]) | Int(data[i + 16]) << 8
+                    result.append(.storeGraphics(key: data[i + 11], width: width, height: height))
+                    i += 7 + p
+                case 0x28 where i + 6 < data.count:
+                    let p = Int(data[i + 3]) | Int(data[i + 4]) << 8
+                    if data[i + 6] == 85 {
+                        result.append(.printGraphics(key: data[i + 8]))
+                    } else if data[i + 6] == 82 {
+                        result.append(.deleteGraphics(key: data[i + 8]))
+                    }
+                    i += 5 + p
+                default:
+                    i += 2
+                }
+            } else if byte == 0x0A {
+                flushText()
+                i += 1
+            } else {
+                text.append(byte)
+                i += 1
+            }
+        }
+        flushText()
+        return result
+    }
+}
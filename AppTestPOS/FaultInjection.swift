@@ -0,0 +1,269 @@
+//
+//  FaultInjection.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+#if DEBUG
+import Foundation
+
+/// SplitMix64: small, fast and fully determined by its seed.
+struct SeededGenerator: RandomNumberGenerator {
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9E37_79B9_7F4A_7C15
+        var z = state
+        z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+        z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+        return z ^ (z >> 31)
+    }
+
+    /// `true` with probability `p`.
+    mutating func chance(_ p: Double) -> Bool {
+        return p > 0 && Double(next() >> 11) / Double(1 << 53) < p
+    }
+}
+
+/// Faults applied to each chunk crossing the link, in either direction.
+struct LinkFaults {
+    var seed: UInt64 = 1
+    /// Probability of dropping one byte of a chunk.
+    var byteLoss = 0.0
+    /// Probability of flipping one bit of a chunk.
+    var corruption = 0.0
+    /// Probability of splitting a chunk at random boundaries, delivered as separate reads.
+    var rechunking = 0.0
+    /// Probability of holding a chunk back for `stallDuration`.
+    var stall = 0.0
+    var stallDuration: TimeInterval = 0.5
+    /// Probability of dropping the connection when a chunk is sent; it comes back after `reconnectDelay`.
+    var disconnect = 0.0
+    var reconnectDelay: TimeInterval = 1
+}
+
+/// Sits between a session and a terminal link (usually `EmulatedTerminalLink`) and injects the
+/// faults a Bluetooth link shows: lost and corrupted bytes, different chunking, stalls and
+/// disconnects. All decisions come from one seeded generator, so a seed replays the same faults
+/// for the same traffic.
+final class FaultInjectingLink: PosLink {
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+
+    var acknowledgesFrames: Bool {
+        return inner.acknowledgesFrames
+    }
+
+    let inner: PosLink
+    let faults: LinkFaults
+    private(set) var isConnected = true
+    private(set) var injected: [String: Int] = [:]
+    /// Called when the link comes back after an injected disconnect.
+    var onReconnect: (() -> Void)?
+
+    private var generator: SeededGenerator
+    private let queue = DispatchQueue(label: "cl.transbank.fault-injection")
+
+    init(wrapping inner: PosLink, faults: LinkFaults) {
+        self.inner = inner
+        self.faults = faults
+        self.generator = SeededGenerator(seed: faults.seed)
+        inner.onReceive = { [weak self] bytes in
+            guard let self = self else { return }
+            self.queue.async { self.forward(bytes) { self.onReceive?($0) } }
+        }
+        inner.onDisconnect = { [weak self] in
+            guard let self = self else { return }
+            self.queue.async { self.onDisconnect?() }
+        }
+    }
+
+    func send(_ bytes: Data) {
+        queue.async {
+            guard self.isConnected else {
+                return
+            }
+            if self.generator.chance(self.faults.disconnect) {
+                self.dropConnection()
+                return
+            }
+            self.forward(bytes) { self.inner.send($0) }
+        }
+    }
+
+    private func forward(_ bytes: Data, to deliver: @escaping (Data) -> Void) {
+        guard isConnected else {
+            return
+        }
+        var data = bytes
+        if !data.isEmpty && generator.chance(faults.byteLoss) {
+            data.remove(at: data.startIndex + Int(generator.next() % UInt64(data.count)))
+            count("byteLoss")
+        }
+        if !data.isEmpty && generator.chance(faults.corruption) {
+            let index = data.startIndex + Int(generator.next() % UInt64(data.count))
+            data[index] ^= UInt8(1) << UInt8(generator.next() % 8)
+            count("corruption")
+        }
+
+        var chunks = [data]
+        if data.count > 1 && generator.chance(faults.rechunking) {
+            chunks = []
+            var rest = data[...]
+            while !rest.isEmpty {
+                let length = 1 + Int(generator.next() % UInt64(rest.count))
+                chunks.append(Data(rest.prefix(length)))
+                rest = rest.dropFirst(length)
+            }
+            count("rechunking")
+        }
+
+        if generator.chance(faults.stall) {
+            count("stall")
+            queue.asyncAfter(deadline: .now() + faults.stallDuration) {
+                if self.isConnected {
+                    chunks.forEach(deliver)
+                }
+            }
+        } else {
+            chunks.forEach(deliver)
+        }
+    }
+
+    private func dropConnection() {
+        count("disconnect")
+        isConnected = false
+        onDisconnect?()
+        queue.asyncAfter(deadline: .now() + faults.reconnectDelay) {
+            self.isConnected = true
+            self.onReconnect?()
+        }
+    }
+
+    private func count(_ fault: String) {
+        injected[fault, default: 0] += 1
+    }
+
+    var injectedFaults: [String: Int] {
+        return queue.sync { injected }
+    }
+}
+
+/// Drives sales through a session over a `FaultInjectingLink` and measures how the stack recovers.
+/// Run with the `-runLinkSimulation` launch argument.
+enum LinkSimulation {
+
+    static let launchArgument = "-runLinkSimulation"
+
+    static let profiles: [(String, LinkFaults)] = [
+        ("clean", LinkFaults()),
+        ("noisy", LinkFaults(seed: 7, byteLoss: 0.01, corruption: 0.02, rechunking: 0.5)),
+        ("stalls", LinkFaults(seed: 11, rechunking: 0.2, stall: 0.05, stallDuration: 0.5)),
+        ("dropouts", LinkFaults(seed: 13, corruption: 0.01, disconnect: 0.02, reconnectDelay: 1)),
+    ]
+
+    static func runIfRequested() {
+        guard ProcessInfo.processInfo.arguments.contains(launchArgument) else {
+            return
+        }
+        DispatchQueue.global(qos: .userInitiated).async {
+            for (name, faults) in profiles {
+                let report = run(faults: faults)
+                print(String(format: "%@ seed %llu: %d/%d sales ok, goodput %.1f/s, recovery mean %.3fs worst %.3fs",
+                             name, report.seed, report.succeeded, report.attempted, report.goodput,
+                             report.meanRecovery, report.worstRecovery))
+                print("  injected \(report.injected) failures \(report.failures)")
+                if report.leftoverCancellationHandlers > 0 {
+                    print("  \(report.leftoverCancellationHandlers) cancellation handlers left on the token")
+                }
+            }
+        }
+    }
+
+    struct Report {
+        let seed: UInt64
+        let attempted: Int
+        let succeeded: Int
+        let failures: [String: Int]
+        let injected: [String: Int]
+        let elapsed: TimeInterval
+        /// Successful sales per second, retries and recovery included.
+        let goodput: Double
+        /// Time from each failure to the next successful command.
+        let recoveryTimes: [TimeInterval]
+        /// Handlers still registered on the run's shared token after every sale ended; should be 0.
+        let leftoverCancellationHandlers: Int
+
+        var meanRecovery: TimeInterval {
+            return recoveryTimes.isEmpty ? 0 : recoveryTimes.reduce(0, +) / Double(recoveryTimes.count)
+        }
+
+        var worstRecovery: TimeInterval {
+            return recoveryTimes.max() ?? 0
+        }
+    }
+
+    /// Runs `sales` sales one after another, retrying a failed one until it succeeds or
+    /// `attemptsPerSale` is spent. Blocks the calling thread.
+    static func run(faults: LinkFaults, sales: Int = 200, attemptsPerSale: Int = 5,
+                    phaseTimeouts: PhaseTimeouts = PhaseTimeouts(delivery: 0.3, cardRead: 1, pin: 1, authorization: 1, printing: 1)) -> Report {
+        let terminal = EmulatedTerminalLink(latency: 0.005)
+        let link = FaultInjectingLink(wrapping: terminal, faults: faults)
+        let host = TerminalSessionHost(executor: CallbackExecutor(label: "cl.transbank.simulation"))
+        let session = host.open(identifier: "simulation", link: link)
+        session.phaseTimeouts = phaseTimeouts
+        /* Un solo token para todas las ventas, como el de la pantalla */
+        let token = CancellationToken()
+
+        var attempted = 0
+        var succeeded = 0
+        var failures: [String: Int] = [:]
+        var recoveryTimes: [TimeInterval] = []
+        var failedAt: TimeInterval?
+        let start = ProcessInfo.processInfo.systemUptime
+
+        for index in 0..<sales {
+            attempts: for _ in 0..<attemptsPerSale {
+                attempted += 1
+                let done = DispatchSemaphore(value: 0)
+                var outcome: Result<SaleResponse, PosError> = .failure(.cancelled)
+                session.sale(amount: 1000 + index, timeout: 10, token: token) { result in
+                    outcome = result
+                    done.signal()
+                }
+                done.wait()
+
+                let now = ProcessInfo.processInfo.systemUptime
+                switch outcome {
+                case .success:
+                    succeeded += 1
+                    if let failed = failedAt {
+                        recoveryTimes.append(now - failed)
+                        failedAt = nil
+                    }
+                    break attempts
+                case .failure(let error):
+                    failures["\(error)", default: 0] += 1
+                    if failedAt == nil {
+                        failedAt = now
+                    }
+                }
+            }
+        }
+
+        let elapsed = ProcessInfo.processInfo.systemUptime - start
+        return Report(seed: faults.seed, attempted: attempted, succeeded: succeeded, failures: failures,
+                      injected: link.injectedFaults, elapsed: elapsed,
+                      goodput: elapsed > 0 ? Double(succeeded) / elapsed : 0, recoveryTimes: recoveryTimes,
+                      leftoverCancellationHandlers: token.handlerCount)
+    }
+}
+
+#endif
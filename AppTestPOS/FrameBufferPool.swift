@@ -0,0 +1,216 @@
+//
+//  FrameBufferPool.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import os
+
+/// Size-classed pool of byte buffers for frames and messages.
+///
+/// A `FrameBuffer` takes its storage from the smallest class that fits and gives it back when
+/// the last reference (the buffer itself or any `FrameSlice` over it) goes away, so steady
+/// traffic reuses the same few blocks instead of allocating per frame. At most
+/// `maximumCachedPerClass` free blocks are kept per class; sizes above the largest class are
+/// allocated exactly and never cached.
+final class FrameBufferPool {
+
+    static let shared = FrameBufferPool()
+    static let sizeClasses = [64, 256, 1024, 4096, 16 * 1024, 64 * 1024]
+
+    struct Statistics {
+        var hits = 0
+        var misses = 0
+    }
+
+    let maximumCachedPerClass: Int
+
+    private var free: [[UnsafeMutablePointer<UInt8>]]
+    private var statistics = Statistics()
+    private let lock: os_unfair_lock_t = {
+        let lock = os_unfair_lock_t.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+
+    init(maximumCachedPerClass: Int = 32) {
+        self.maximumCachedPerClass = maximumCachedPerClass
+        self.free = FrameBufferPool.sizeClasses.map { _ in [] }
+    }
+
+    deinit {
+        for blocks in free {
+            blocks.forEach { $0.deallocate() }
+        }
+        lock.deinitialize(count: 1)
+        lock.deallocate()
+    }
+
+    /// An empty buffer with room for at least `minimumCapacity` bytes.
+    func buffer(minimumCapacity: Int = 256) -> FrameBuffer {
+        return FrameBuffer(pool: self, minimumCapacity: minimumCapacity)
+    }
+
+    var currentStatistics: Statistics {
+        os_unfair_lock_lock(lock)
+        defer { os_unfair_lock_unlock(lock) }
+        return statistics
+    }
+
+    static func sizeClass(for capacity: Int) -> Int? {
+        return sizeClasses.firstIndex { $0 >= capacity }
+    }
+
+    fileprivate func take(_ minimumCapacity: Int) -> (UnsafeMutablePointer<UInt8>, Int) {
+        guard let index = FrameBufferPool.sizeClass(for: minimumCapacity) else {
+            return (UnsafeMutablePointer<UInt8>.allocate(capacity: minimumCapacity), minimumCapacity)
+        }
+        let capacity = FrameBufferPool.sizeClasses[index]
+        os_unfair_lock_lock(lock)
+        if let block = free[index].popLast() {
+            statistics.hits += 1
+            os_unfair_lock_unlock(lock)
+            return (block, capacity)
+        }
+        statistics.misses += 1
+        os_unfair_lock_unlock(lock)
+        return (UnsafeMutablePointer<UInt8>.allocate(capacity: capacity), capacity)
+    }
+
+    fileprivate func recycle(_ block: UnsafeMutablePointer<UInt8>, capacity: Int) {
+        if let index = FrameBufferPool.sizeClasses.firstIndex(of: capacity) {
+            os_unfair_lock_lock(lock)
+            if free[index].count < maximumCachedPerClass {
+                free[index].append(block)
+                os_unfair_lock_unlock(lock)
+                return
+            }
+            os_unfair_lock_unlock(lock)
+        }
+        block.deallocate()
+    }
+}
+
+/// Growable byte buffer backed by a pool block. Bytes already handed out as slices are never
+/// rewritten: appending only writes past them, and growing copies them to a larger block.
+/// Not thread-safe; a buffer belongs to whoever is filling it.
+final class FrameBuffer {
+
+    let pool: FrameBufferPool
+    private(set) var storage: UnsafeMutablePointer<UInt8>
+    private(set) var capacity: Int
+    private(set) var count = 0
+
+    fileprivate init(pool: FrameBufferPool, minimumCapacity: Int) {
+        self.pool = pool
+        (storage, capacity) = pool.take(max(minimumCapacity, 1))
+    }
+
+    deinit {
+        pool.recycle(storage, capacity: capacity)
+    }
+
+    func append(_ byte: UInt8) {
+        if count == capacity {
+            grow(to: count + 1)
+        }
+        storage[count] = byte
+        count += 1
+    }
+
+    func append<C: Collection>(contentsOf bytes: C) where C.Element == UInt8 {
+        if count + bytes.count > capacity {
+            grow(to: count + bytes.count)
+        }
+        let copied = bytes.withContiguousStorageIfAvailable { source -> Bool in
+            if let base = source.baseAddress {
+                (storage + count).initialize(from: base, count: source.count)
+            }
+            return true
+        }
+        if copied == nil {
+            var index = count
+            for byte in bytes {
+                storage[index] = byte
+                index += 1
+            }
+        }
+        count += bytes.count
+    }
+
+    /// Forgets the contents. Only call this while no slice of the buffer is alive, e.g. after
+    /// checking `isKnownUniquelyReferenced`.
+    func removeAll() {
+        count = 0
+    }
+
+    /// Drops the bytes after `count`, which must not be covered by any slice.
+    func truncate(to count: Int) {
+        precondition(count >= 0 && count <= self.count, "truncate out of bounds")
+        self.count = count
+    }
+
+    /// Zero-copy view of `range`; keeps the buffer (and its block) alive.
+    func slice(_ range: Range<Int>) -> FrameSlice {
+        precondition(range.lowerBound >= 0 && range.upperBound <= count, "slice out of bounds")
+        return FrameSlice(buffer: self, range: range)
+    }
+
+    var bytes: FrameSlice {
+        return slice(0..<count)
+    }
+
+    private func grow(to minimumCapacity: Int) {
+        let (block, newCapacity) = pool.take(max(minimumCapacity, capacity * 2))
+        block.initialize(from: storage, count: count)
+        pool.recycle(storage, capacity: capacity)
+        storage = block
+        capacity = newCapacity
+    }
+}
+
+/// Reference-counted, zero-copy range of a `FrameBuffer`, indexed from 0.
+struct FrameSlice: RandomAccessCollection {
+
+    let buffer: FrameBuffer
+    let range: Range<Int>
+
+    var startIndex: Int {
+        return 0
+    }
+
+    var endIndex: Int {
+        return range.count
+    }
+
+    subscript(position: Int) -> UInt8 {
+        precondition(position >= 0 && position < range.count, "index out of bounds")
+        return buffer.storage[range.lowerBound + position]
+    }
+
+    /// Sub-range of this slice sharing the same buffer.
+    func slice(_ bounds: Range<Int>) -> FrameSlice {
+        precondition(bounds.lowerBound >= 0 && bounds.upperBound <= range.count, "slice out of bounds")
+        return FrameSlice(buffer: buffer, range: (range.lowerBound + bounds.lowerBound)..<(range.lowerBound + bounds.upperBound))
+    }
+
+    func withContiguousStorageIfAvailable<R>(_ body: (UnsafeBufferPointer<UInt8>) throws -> R) rethrows -> R? {
+        return try withExtendedLifetime(buffer) {
+            try body(UnsafeBufferPointer(start: buffer.storage + range.lowerBound, count: range.count))
+        }
+    }
+
+    func withUnsafeBytes<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+        return try withExtendedLifetime(buffer) {
+            try body(UnsafeRawBufferPointer(start: buffer.storage + range.lowerBound, count: range.count))
+        }
+    }
+
+    /// A copy of the bytes, for APIs that need `Data`.
+    var data: Data {
+        return withUnsafeBytes { Data($0) }
+    }
+}
@@ -0,0 +1,272 @@
+//
+//  FuzzHarness.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+#if DEBUG
+import Foundation
+import iSMP
+
+/// Mutation fuzzing of everything that parses terminal output: hex decoding, the frame parser,
+/// the '|' tokenizer and typed decoders, TLV and the standalone reply views.
+///
+/// Inputs are mutated from a corpus of captured-style traffic with a seeded generator, so a
+/// failure is reproduced by its seed and iteration. A crash is a failure; so is a broken
+/// round-trip property, which is recorded with the offending input. Each target runs for a
+/// bounded time. Run with the `-runFuzz` launch argument.
+enum FuzzHarness {
+
+    static let launchArgument = "-runFuzz"
+
+    struct Failure {
+        let target: String
+        let iteration: Int
+        let input: Data
+        let reason: String
+    }
+
+    struct Report {
+        let target: String
+        let executions: Int
+        let seconds: Double
+        let failures: [Failure]
+
+        var executionsPerSecond: Double {
+            return seconds > 0 ? Double(executions) / seconds : 0
+        }
+    }
+
+    /// Captured-style payloads used as mutation seeds.
+    static let corpus: [Data] = [
+        "0210|00|597029414300|12345678|123456|000001|15000|0|0|6543|1|CR|1810|123456|VI|18102026|120000|0|0",
+        "0260|00|597029414300|12345678|7|000007|1007|6543|7|CR|1810|123456|VI|18102026|120000|0|0|0|0",
+        "0260|00|597029414300|12345678||||||||||||||||",
+        "0510|00|597029414300|12345678",
+        "0710|00|12|180000",
+        "0810|00|597029414300|12345678",
+        "1210|00|597029414300|12345678|000001|1",
+        "0900|78",
+        "0200|15000|123456|||0",
+    ].map { Data($0.utf8) } + [
+        Data([0x9F, 0x02, 0x06, 0x00, 0x00, 0x00, 0x01, 0x50, 0x00, 0x5F, 0x2A, 0x02, 0x01, 0x52]),
+        Data([0x77, 0x0A, 0x9F, 0x27, 0x01, 0x80, 0x8A, 0x02, 0x30, 0x30, 0x9B, 0x00]),
+        Data([0x00, 0xFF, 0x5A, 0x81, 0x08, 0x47, 0x61, 0x73, 0x90, 0x01, 0x01, 0x01, 0x19]),
+    ]
+
+    static func runIfRequested() {
+        guard ProcessInfo.processInfo.arguments.contains(launchArgument) else {
+            return
+        }
+        DispatchQueue.global(qos: .utility).async {
+            for report in runAll(seed: 1, secondsPerTarget: 5) {
+                print(String(format: "fuzz %@: %d execs (%.0f/s), %d failures",
+                             report.target, report.executions, report.executionsPerSecond, report.failures.count))
+                for failure in report.failures.prefix(5) {
+                    print("  #\(failure.iteration) \(failure.reason): \(PosFrame.hexEncoded(failure.input))")
+                }
+            }
+        }
+    }
+
+    static func runAll(seed: UInt64, secondsPerTarget: Double) -> [Report] {
+        return [
+            run("hex", seed: seed, seconds: secondsPerTarget, hex),
+            run("parser", seed: seed, seconds: secondsPerTarget, parser),
+            run("tokenizer", seed: seed, seconds: secondsPerTarget, tokenizer),
+            run("tlv", seed: seed, seconds: secondsPerTarget, tlv),
+            run("replyView", seed: seed, seconds: secondsPerTarget, replyView),
+            run("checksum", seed: seed, seconds: secondsPerTarget, checksum),
+        ]
+    }
+
+    /// Runs `target` on mutated inputs until `seconds` have passed; `target` returns a reason
+    /// string when a property does not hold.
+    static func run(_ name: String, seed: UInt64, seconds: Double,
+                    _ target: (Data, inout SeededGenerator) -> String?) -> Report {
+        var generator = SeededGenerator(seed: seed)
+        var failures: [Failure] = []
+        var executions = 0
+        let start = ProcessInfo.processInfo.systemUptime
+        var elapsed = 0.0
+        while elapsed < seconds {
+            for _ in 0..<256 {
+                let input = mutate(corpus[Int(generator.next() % UInt64(corpus.count))], &generator)
+                if let reason = target(input, &generator) {
+                    failures.append(Failure(target: name, iteration: executions, input: input, reason: reason))
+                }
+                executions += 1
+            }
+            elapsed = ProcessInfo.processInfo.systemUptime - start
+        }
+        return Report(target: name, executions: executions, seconds: elapsed, failures: failures)
+    }
+
+    static func mutate(_ seed: Data, _ generator: inout SeededGenerator) -> Data {
+        var data = seed
+        let interesting: [UInt8] = [PosFrame.STX, PosFrame.ETX, PosFrame.ACK, PosFrame.NAK, PosFrame.separator, 0x00, 0x80, 0xFF]
+        for _ in 0..<(1 + Int(generator.next() % 4)) {
+            let position = data.isEmpty ? 0 : Int(generator.next() % UInt64(data.count))
+            switch generator.next() % 6 {
+            case 0 where !data.isEmpty:
+                data[position] ^= UInt8(1) << UInt8(generator.next() % 8)
+            case 1:
+                data.insert(interesting[Int(generator.next() % UInt64(interesting.count))], at: position)
+            case 2 where !data.isEmpty:
+                data.remove(at: position)
+            case 3 where !data.isEmpty:
+                data.removeSubrange(position..<data.count)
+            case 4:
+                let other = corpus[Int(generator.next() % UInt64(corpus.count))]
+                data.append(other.prefix(Int(generator.next() % UInt64(other.count + 1))))
+            default:
+                data.insert(UInt8(truncatingIfNeeded: generator.next()), at: position)
+            }
+        }
+        return data
+    }
+
+    // MARK: - Targets
+
+    static func hex(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        let encoded = PosFrame.hexEncoded(input)
+        guard PosFrame.hexDecoded(encoded) == input else {
+            return "hex round trip"
+        }
+        /* Texto arbitrario: no debe fallar y, si decodifica, debe volver a codificar igual */
+        let text = String(decoding: input, as: UTF8.self)
+        if let decoded = PosFrame.hexDecoded(text), text.count % 2 == 0, text.utf8.allSatisfy({ $0 < 0x80 && $0 != 0x20 && $0 != UInt8(ascii: "x") && $0 != UInt8(ascii: "X") }) {
+            guard PosFrame.hexEncoded(decoded) == text.uppercased() else {
+                return "hex re-encode"
+            }
+        }
+        return nil
+    }
+
+    static func parser(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        let parser = PosFrameParser(maximumFrameLength: 512)
+        var rest = input[...]
+        while !rest.isEmpty {
+            let length = 1 + Int(generator.next() % UInt64(rest.count))
+            _ = parser.feed(rest.prefix(length))
+            rest = rest.dropFirst(length)
+        }
+
+        /* Un payload sin bytes de control debe salir intacto sin importar el troceo */
+        let payload = Data(input.filter { $0 != PosFrame.STX && $0 != PosFrame.ETX }.prefix(512))
+        let frame = PosFrame.encode(payload: payload)
+        let clean = PosFrameParser(maximumFrameLength: 512)
+        var events: [PosFrameParser.Event] = []
+        var bytes = frame[...]
+        while !bytes.isEmpty {
+            let length = 1 + Int(generator.next() % UInt64(bytes.count))
+            events += clean.feed(bytes.prefix(length))
+            bytes = bytes.dropFirst(length)
+        }
+        guard events.count == 1, case .frame(let response) = events[0], Data(response.payload) == payload else {
+            return "frame round trip"
+        }
+        return nil
+    }
+
+    static func tokenizer(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        let response = PosResponse(payload: input)
+        let separators = input.filter { $0 == PosFrame.separator }.count
+        guard response.fieldCount == separators + 1 else {
+            return "field count"
+        }
+        for index in -1...(response.fieldCount) {
+            guard response.integer(index) == response.field(index).flatMap({ Int($0) }) else {
+                return "integer parse"
+            }
+        }
+        _ = SaleResponse(response)
+        _ = RefundResponse(response)
+        _ = KeyLoadResponse(response)
+        _ = CloseResponse(response)
+        _ = TotalsResponse(response)
+        _ = DetailRecord(response)
+        return nil
+    }
+
+    static func tlv(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        let reader = TLVReader(input)
+        var count = 0
+        for element in reader {
+            count += 1
+            if element.tag.isConstructed {
+                _ = element.children.isWellFormed
+            }
+        }
+        _ = reader.isWellFormed
+        _ = reader[.amountAuthorised]
+        _ = reader.element(.authorisationResponseCode, recursive: true)
+
+        /* Lo que se lee bien debe reescribirse idéntico salvo relleno y longitudes no mínimas */
+        if reader.isWellFormed {
+            var writer = TLVWriter()
+            for element in reader {
+                writer.append(element.tag, element.value)
+            }
+            let rewritten = Array(TLVReader(writer.data))
+            guard rewritten.count == count, zip(rewritten, reader).allSatisfy({ $0.tag == $1.tag && $0.value == $1.value }) else {
+                return "tlv rewrite"
+            }
+        }
+        return nil
+    }
+
+    static func replyView(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        var reply = ICTransactionReply()
+        withUnsafeMutableBytes(of: &reply) { bytes in
+            for index in 0..<bytes.count {
+                bytes[index] = input.isEmpty ? 0 : input[input.startIndex + index % input.count]
+            }
+        }
+        let view = TransactionReplyView(reply)
+        _ = view.outcome
+        _ = view.currency
+        _ = view.withZoneRep { TLVReader.withReader(over: $0) { $0.isWellFormed } }
+
+        /* El parse SWAR debe coincidir con el parse carácter a carácter */
+        let word = generator.next()
+        let bytes = withUnsafeBytes(of: word.littleEndian) { Array($0) }
+        let reference = bytes.allSatisfy { $0 >= 0x30 && $0 <= 0x39 }
+            ? UInt32(String(decoding: bytes, as: UTF8.self)) : nil
+        guard AsciiDigits.parse8(word) == reference else {
+            return "parse8"
+        }
+        let value = UInt32(word % 100_000_000)
+        guard AsciiDigits.parse8(AsciiDigits.format8(value)) == value else {
+            return "format8"
+        }
+        return nil
+    }
+
+    /// Every LRC kernel agrees with the byte loop at every alignment, and the CRCs match their
+    /// published check values and chunked computation.
+    static func checksum(_ input: Data, _ generator: inout SeededGenerator) -> String? {
+        let check = Data("123456789".utf8)
+        guard Checksum.crc32c(check) == 0xE306_9283, Checksum.crc16(check, .ccittFalse) == 0x29B1,
+              Checksum.crc16(check, .xmodem) == 0x31C3, Checksum.crc16(check, .arc) == 0xBB3D else {
+            return "check value"
+        }
+        var padded = Data(count: 16) + input + input + input
+        padded.removeFirst(Int(generator.next() % 16))
+        let result: String? = padded.withUnsafeBytes { bytes in
+            let reference = Checksum.lrcBytes(bytes)
+            guard Checksum.lrcWords(bytes) == reference, Checksum.lrcVectors(bytes) == reference,
+                  Checksum.lrc(bytes) == reference else {
+                return "lrc kernels"
+            }
+            let split = bytes.isEmpty ? 0 : Int(generator.next() % UInt64(bytes.count))
+            let chunked = Checksum.crc32c(UnsafeRawBufferPointer(rebasing: bytes[split...]),
+                                          continuing: Checksum.crc32c(UnsafeRawBufferPointer(rebasing: bytes[..<split])))
+            return chunked == Checksum.crc32c(bytes) ? nil : "crc32c chunking"
+        }
+        return result
+    }
+}
+#endif
@@ -0,0 +1,171 @@
+//
+//  KeyLoadOrchestrator.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Loads keys (0800) on a fleet of sessions for one rotation.
+///
+/// At most `maximumConcurrent` terminals load at once; a terminal that fails is retried with
+/// exponential backoff until its `attemptsPerTerminal` budget is spent. Progress is written to a
+/// property list after every attempt, so after a restart the same rotation skips the terminals
+/// that already succeeded.
+final class KeyLoadOrchestrator {
+
+    enum State: String, Codable {
+        case pending
+        case loaded
+        case failed
+    }
+
+    struct TerminalProgress: Codable {
+        var state: State = .pending
+        var attempts = 0
+        var lastError: String?
+        var loadedAt: Date?
+    }
+
+    private struct Progress: Codable {
+        var rotation: String
+        var terminals: [String: TerminalProgress]
+    }
+
+    let rotation: String
+    let url: URL
+    var maximumConcurrent = 6
+    var attemptsPerTerminal = 3
+    var initialBackoff: TimeInterval = 2
+    var timeout: TimeInterval = 60
+    /// Runs on the orchestrator's queue after every attempt.
+    var onProgress: ((String, TerminalProgress) -> Void)?
+
+    private let queue = DispatchQueue(label: "cl.transbank.key-load")
+    private var progress: Progress
+
+    /// `rotation` identifies the key rotation (e.g. the date); progress saved for another
+    /// rotation is discarded.
+    init(rotation: String, url: URL = KeyLoadOrchestrator.defaultURL()) {
+        self.rotation = rotation
+        self.url = url
+        if let data = try? Data(contentsOf: url),
+           let saved = try? PropertyListDecoder().decode(Progress.self, from: data),
+           saved.rotation == rotation {
+            progress = saved
+        } else {
+            progress = Progress(rotation: rotation, terminals: [:])
+        }
+    }
+
+    static func defaultURL() -> URL {
+        let directory = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask)[0]
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        return directory.appendingPathComponent("key-load-progress.plist")
+    }
+
+    func progress(_ terminal: String) -> TerminalProgress? {
+        return queue.sync { progress.terminals[terminal] }
+    }
+
+    /// A run of this rotation left terminals pending, e.g. because the app was closed mid-run;
+    /// running again without `force` resumes it.
+    var hasUnfinishedRun: Bool {
+        return queue.sync { progress.terminals.values.contains { $0.state == .pending } }
+    }
+
+    /// Loads keys on every session not yet loaded in this rotation, or on every session with
+    /// `force` (an explicit request from the operator); `completion` runs on the orchestrator's
+    /// queue with the progress of each session.
+    func run(_ sessions: [TerminalSession], force: Bool = false, token: CancellationToken? = nil,
+             completion: @escaping ([String: TerminalProgress]) -> Void) {
+        queue.async {
+            if force {
+                for session in sessions {
+                    self.progress.terminals[session.identifier] = nil
+                }
+            }
+            var waiting = sessions.filter { self.progress.terminals[$0.identifier]?.state != .loaded }[...]
+            for session in waiting where self.progress.terminals[session.identifier]?.state != .pending {
+                /* Una nueva corrida vuelve a dar presupuesto a los terminales que fallaron; todos quedan pendientes */
+                self.progress.terminals[session.identifier] = TerminalProgress()
+            }
+            /* Se guarda antes del primer intento para que una corrida interrumpida se pueda reanudar */
+            self.save()
+            var running = 0
+
+            func finished() {
+                running -= 1
+                pump()
+            }
+
+            func attempt(_ session: TerminalSession) {
+                let terminal = session.identifier
+                session.loadKeys(timeout: self.timeout, token: token) { result in
+                    self.queue.async {
+                        var entry = self.progress.terminals[terminal] ?? TerminalProgress()
+                        entry.attempts += 1
+                        switch result {
+                        case .success(let response) where response.isApproved:
+                            entry.state = .loaded
+                            entry.loadedAt = Date()
+                            entry.lastError = nil
+                        case .success(let response):
+                            entry.lastError = "código \(response.responseCode)"
+                        case .failure(let error):
+                            entry.lastError = "\(error)"
+                        }
+                        let cancelled = token?.isCancelled ?? false
+                        if entry.state != .loaded && (entry.attempts >= self.attemptsPerTerminal || cancelled) {
+                            entry.state = .failed
+                        }
+                        self.progress.terminals[terminal] = entry
+                        self.save()
+                        self.onProgress?(terminal, entry)
+
+                        if entry.state == .pending {
+                            let backoff = self.initialBackoff * pow(2, Double(entry.attempts - 1))
+                            self.queue.asyncAfter(deadline: .now() + backoff) {
+                                attempt(session)
+                            }
+                        } else {
+                            finished()
+                        }
+                    }
+                }
+            }
+
+            func pump() {
+                while running < self.maximumConcurrent, let session = waiting.popFirst() {
+                    running += 1
+                    attempt(session)
+                }
+                if running == 0 && waiting.isEmpty {
+                    var result: [String: TerminalProgress] = [:]
+                    for session in sessions {
+                        result[session.identifier] = self.progress.terminals[session.identifier]
+                    }
+                    completion(result)
+                }
+            }
+            pump()
+        }
+    }
+
+    /// Forgets this rotation's progress.
+    func reset() {
+        queue.async {
+            self.progress.terminals.removeAll()
+            self.save()
+        }
+    }
+
+    private func save() {
+        guard let data = try? PropertyListEncoder().encode(progress) else {
+            return
+        }
+        try? data.write(to: url, options: .atomic)
+    }
+}
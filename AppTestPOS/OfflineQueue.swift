@@ -0,0 +1,383 @@
+//
+//  OfflineQueue.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import Network
+
+/// An operation kept while the acquirer link is down, e.g. the command of a sale.
+struct OfflineOperation {
+    let id: UInt64
+    let command: String
+    let createdAt: Date
+}
+
+/// Durable store-and-forward queue backed by an append-only log.
+///
+/// Each record is `[length: UInt32][checksum: UInt32][payload]`, little-endian; the checksum is
+/// CRC32C, and FNV-1a from older logs is still accepted on replay. Appends made
+/// within `commitInterval` of each other are written with one `write` and one `fsync` (group
+/// commit) and their completions run only after the sync; a batch whose write or sync fails is
+/// cut off the log again. On open the log is replayed up to the first torn or corrupt record and
+/// truncated there, so a crash mid-write loses at most the batch that was never acknowledged.
+final class OfflineQueue {
+
+    private enum RecordKind: UInt8 {
+        case operation = 1
+        case done = 2
+    }
+
+    let url: URL
+    var commitInterval: TimeInterval = 0.005
+    var maximumBatch = 256
+
+    private let queue = DispatchQueue(label: "cl.transbank.offline-queue")
+    private var fd: Int32 = -1
+    private var pending: [UInt64: OfflineOperation] = [:]
+    private var inFlight: Set<UInt64> = []
+    private var nextId: UInt64 = 1
+    private var batch = Data()
+    private var batchCompletions: [(Bool) -> Void] = []
+    private var commitScheduled = false
+    private var draining = false
+
+    /// Opens (or creates) the log at `url` and replays it.
+    init?(url: URL) {
+        self.url = url
+        let fd = open(url.path, O_RDWR | O_CREAT, 0o600)
+        guard fd >= 0 else {
+            return nil
+        }
+        self.fd = fd
+        recover()
+    }
+
+    static func defaultURL() -> URL {
+        let directory = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask)[0]
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        return directory.appendingPathComponent("offline-queue.log")
+    }
+
+    deinit {
+        if fd >= 0 {
+            close(fd)
+        }
+    }
+
+    var count: Int {
+        return queue.sync { pending.count }
+    }
+
+    var operations: [OfflineOperation] {
+        return queue.sync { pending.values.sorted { $0.id < $1.id } }
+    }
+
+    /// Stores `command`; `completion` runs on the queue once it is on disk (`false` if the write failed).
+    func enqueue(_ command: String, completion: ((Bool) -> Void)? = nil) {
+        queue.async {
+            let operation = OfflineOperation(id: self.nextId, command: command, createdAt: Date())
+            self.nextId += 1
+            self.pending[operation.id] = operation
+            self.append(.operation, id: operation.id, date: operation.createdAt, command: command, completion: completion)
+        }
+    }
+
+    /// Marks `id` as forwarded; it will not be replayed after a restart.
+    func complete(_ id: UInt64) {
+        queue.async {
+            self.markDone(id)
+        }
+    }
+
+    /// Forwards every pending operation through `send`, at most `maximumConcurrent` at a time.
+    /// `send` reports whether the operation was accepted; rejected ones stay queued and the drain
+    /// stops handing out new work. `completion` runs on the queue with the number forwarded.
+    func drain(maximumConcurrent: Int = 4,
+               send: @escaping (OfflineOperation, @escaping (Bool) -> Void) -> Void,
+               completion: ((Int) -> Void)? = nil) {
+        queue.async {
+            guard !self.draining else {
+                completion?(0)
+                return
+            }
+            self.draining = true
+            var remaining = self.pending.values.filter { !self.inFlight.contains($0.id) }.sorted { $0.id < $1.id }[...]
+            var running = 0
+            var forwarded = 0
+            var failed = false
+
+            func pump() {
+                while running < maximumConcurrent, !failed, let operation = remaining.popFirst() {
+                    running += 1
+                    self.inFlight.insert(operation.id)
+                    send(operation) { accepted in
+                        self.queue.async {
+                            running -= 1
+                            self.inFlight.remove(operation.id)
+                            if accepted {
+                                forwarded += 1
+                                self.markDone(operation.id)
+                            } else {
+                                failed = true
+                            }
+                            pump()
+                        }
+                    }
+                }
+                if running == 0 && (failed || remaining.isEmpty) && self.draining {
+                    self.draining = false
+                    self.compactIfEmpty()
+                    completion?(forwarded)
+                }
+            }
+            pump()
+        }
+    }
+
+    // MARK: - Log
+
+    private func markDone(_ id: UInt64) {
+        guard pending.removeValue(forKey: id) != nil else {
+            return
+        }
+        append(.done, id: id, date: Date(), command: "", completion: nil)
+    }
+
+    private func append(_ kind: RecordKind, id: UInt64, date: Date, command: String, completion: ((Bool) -> Void)?) {
+        var payload = Data(capacity: 17 + command.utf8.count)
+        payload.append(kind.rawValue)
+        withUnsafeBytes(of: id.littleEndian) { payload.append(contentsOf: $0) }
+        withUnsafeBytes(of: date.timeIntervalSince1970.bitPattern.littleEndian) { payload.append(contentsOf: $0) }
+        payload.append(contentsOf: command.utf8)
+
+        withUnsafeBytes(of: UInt32(payload.count).littleEndian) { batch.append(contentsOf: $0) }
+        withUnsafeBytes(of: OfflineQueue.checksum(payload).littleEndian) { batch.append(contentsOf: $0) }
+        batch.append(payload)
+        if let completion = completion {
+            batchCompletions.append(completion)
+        }
+
+        if batchCompletions.count >= maximumBatch {
+            commit()
+        } else if !commitScheduled {
+            commitScheduled = true
+            queue.asyncAfter(deadline: .now() + commitInterval) {
+                self.commit()
+            }
+        }
+    }
+
+    private func commit() {
+        commitScheduled = false
+        guard !batch.isEmpty else {
+            return
+        }
+        let data = batch
+        let completions = batchCompletions
+        batch = Data()
+        batchCompletions = []
+
+        let start = lseek(fd, 0, SEEK_CUR)
+        var written = 0
+        data.withUnsafeBytes { bytes in
+            while written < bytes.count {
+                let result = write(fd, bytes.baseAddress! + written, bytes.count - written)
+                if result < 0 {
+                    if errno == EINTR {
+                        continue
+                    }
+                    break
+                }
+                written += result
+            }
+        }
+        let synced = written == data.count && fsync(fd) == 0
+        if !synced {
+            print("OfflineQueue: write failed (\(errno))")
+            /* Se quitan los bytes parciales del lote para que el siguiente quede alineado a un registro */
+            if start >= 0 && ftruncate(fd, start) == 0 {
+                lseek(fd, start, SEEK_SET)
+            }
+        }
+        completions.forEach { $0(synced) }
+    }
+
+    private func recover() {
+        let end = lseek(fd, 0, SEEK_END)
+        guard end > 0 else {
+            return
+        }
+        var log = Data(count: Int(end))
+        let read = log.withUnsafeMutableBytes { pread(fd, $0.baseAddress!, Int(end), 0) }
+        guard read == Int(end) else {
+            return
+        }
+
+        var offset = 0
+        while log.count - offset >= 8 {
+            let length = Int(OfflineQueue.uint32(log, at: offset))
+            let checksum = OfflineQueue.uint32(log, at: offset + 4)
+            guard length >= 17, log.count - offset - 8 >= length else {
+                break
+            }
+            let payload = log.subdata(in: (offset + 8)..<(offset + 8 + length))
+            /* Los registros escritos antes de CRC32C llevan FNV-1a y siguen siendo válidos */
+            guard OfflineQueue.checksum(payload) == checksum || OfflineQueue.legacyChecksum(payload) == checksum else {
+                break
+            }
+            replay(payload)
+            offset += 8 + length
+        }
+        if offset < log.count {
+            /* Registro incompleto o corrupto al final: se descarta */
+            print("OfflineQueue: truncating \(log.count - offset) bytes of torn log")
+            _ = ftruncate(fd, off_t(offset))
+            _ = fsync(fd)
+        }
+        lseek(fd, off_t(offset), SEEK_SET)
+    }
+
+    private func replay(_ payload: Data) {
+        let id = OfflineQueue.uint64(payload, at: 1)
+        nextId = max(nextId, id + 1)
+        switch RecordKind(rawValue: payload[payload.startIndex]) {
+        case .operation?:
+            let date = Date(timeIntervalSince1970: Double(bitPattern: OfflineQueue.uint64(payload, at: 9)))
+            let command = String(decoding: payload.dropFirst(17), as: UTF8.self)
+            pending[id] = OfflineOperation(id: id, command: command, createdAt: date)
+        case .done?:
+            pending.removeValue(forKey: id)
+        case nil:
+            break
+        }
+    }
+
+    /// With nothing pending the log is only tombstones and can be emptied.
+    private func compactIfEmpty() {
+        commit()
+        guard pending.isEmpty, inFlight.isEmpty else {
+            return
+        }
+        if ftruncate(fd, 0) == 0 {
+            lseek(fd, 0, SEEK_SET)
+            _ = fsync(fd)
+        }
+    }
+
+    private static func uint32(_ data: Data, at offset: Int) -> UInt32 {
+        var value: UInt32 = 0
+        for index in (0..<4).reversed() {
+            value = value << 8 | UInt32(data[data.startIndex + offset + index])
+        }
+        return value
+    }
+
+    private static func uint64(_ data: Data, at offset: Int) -> UInt64 {
+        var value: UInt64 = 0
+        for index in (0..<8).reversed() {
+            value = value << 8 | UInt64(data[data.startIndex + offset + index])
+        }
+        return value
+    }
+
+    /// CRC32C over the payload.
+    static func checksum(_ payload: Data) -> UInt32 {
+        return Checksum.crc32c(payload)
+    }
+
+    /// FNV-1a over the payload, the record checksum of logs written by earlier versions.
+    static func legacyChecksum(_ payload: Data) -> UInt32 {
+        var hash: UInt32 = 0x811C_9DC5
+        for byte in payload {
+            hash = (hash ^ UInt32(byte)) &* 0x0100_0193
+        }
+        return hash
+    }
+}
+
+/*Informa al terminal si el servidor es alcanzable y dispara el envío de la cola al recuperarse*/
+@available(iOS 12.0, *)
+final class ServerReachability {
+
+    /// Runs on the monitor's queue with the first path and then on every change.
+    var onChange: ((Bool) -> Void)?
+    /// `nil` until the monitor reports its first path.
+    private(set) var isReachable: Bool?
+
+    private let monitor: NWPathMonitor
+    private let queue = DispatchQueue(label: "cl.transbank.reachability")
+
+    init(monitor: NWPathMonitor = NWPathMonitor()) {
+        self.monitor = monitor
+    }
+
+    func start() {
+        monitor.pathUpdateHandler = { [weak self] path in
+            guard let self = self else { return }
+            let reachable = path.status == .satisfied
+            /* El primer path siempre se informa, también si la app arranca sin red */
+            guard reachable != self.isReachable else {
+                return
+            }
+            self.isReachable = reachable
+            self.onChange?(reachable)
+        }
+        monitor.start(queue: queue)
+    }
+
+    func stop() {
+        monitor.cancel()
+    }
+}
+
+#if DEBUG
+/// Append and drain throughput of `OfflineQueue` against a local stand-in for the host.
+enum OfflineQueueBenchmark {
+
+    struct Result {
+        let operations: Int
+        let appendSeconds: Double
+        let drainSeconds: Double
+
+        var appendsPerSecond: Double {
+            return Double(operations) / appendSeconds
+        }
+
+        var drainsPerSecond: Double {
+            return Double(operations) / drainSeconds
+        }
+    }
+
+    /// The stand-in host accepts each operation after `hostLatency` seconds.
+    static func run(operations: Int = 2000, maximumConcurrent: Int = 4, hostLatency: TimeInterval = 0.002,
+                    completion: @escaping (Result) -> Void) {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("offline-queue-benchmark-\(UUID().uuidString).log")
+        guard let queue = OfflineQueue(url: url) else {
+            return
+        }
+        let host = DispatchQueue(label: "cl.transbank.offline-queue.host", attributes: .concurrent)
+        let group = DispatchGroup()
+        let start = DispatchTime.now()
+        for index in 0..<operations {
+            group.enter()
+            queue.enqueue("0200|\(1000 + index)|\(index)|||0") { _ in group.leave() }
+        }
+        group.notify(queue: .global()) {
+            let appended = DispatchTime.now()
+            queue.drain(maximumConcurrent: maximumConcurrent, send: { _, done in
+                host.asyncAfter(deadline: .now() + hostLatency) { done(true) }
+            }, completion: { _ in
+                let drained = DispatchTime.now()
+                try? FileManager.default.removeItem(at: url)
+                completion(Result(operations: operations,
+                                  appendSeconds: Double(appended.uptimeNanoseconds - start.uptimeNanoseconds) / 1e9,
+                                  drainSeconds: Double(drained.uptimeNanoseconds - appended.uptimeNanoseconds) / 1e9))
+            })
+        }
+    }
+}
+#endif
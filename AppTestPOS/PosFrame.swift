@@ -0,0 +1,284 @@
+//
+//  PosFrame.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Framing of the POS integrado protocol: STX + command + ETX + LRC, where the LRC is the XOR of
+/// every byte after STX up to and including ETX.
+enum PosFrame {
+    static let STX: UInt8 = 0x02
+    static let ETX: UInt8 = 0x03
+    static let ACK: UInt8 = 0x06
+    static let NAK: UInt8 = 0x15
+    static let separator = UInt8(ascii: "|")
+
+    static func encode(_ command: String) -> Data {
+        return encode(payload: Data(command.utf8))
+    }
+
+    static func encode(payload: Data) -> Data {
+        var frame = Data(capacity: payload.count + 3)
+        frame.append(STX)
+        frame.append(payload)
+        frame.append(ETX)
+        frame.append(lrc(payload) ^ ETX)
+        return frame
+    }
+
+    static func lrc<S: Sequence>(_ bytes: S) -> UInt8 where S.Element == UInt8 {
+        var lrc: UInt8 = 0
+        for byte in bytes {
+            lrc ^= byte
+        }
+        return lrc
+    }
+
+    static func lrc(_ data: Data) -> UInt8 {
+        return Checksum.lrc(data)
+    }
+
+    static func hexEncoded(_ data: Data) -> String {
+        return data.map { String(format: "%02X", $0) }.joined()
+    }
+
+    /// Nibble value of each ASCII byte; 0xFF for bytes that are not hex digits.
+    private static let hexValues: [UInt8] = {
+        var table = [UInt8](repeating: 0xFF, count: 256)
+        for (index, byte) in "0123456789ABCDEF".utf8.enumerated() {
+            table[Int(byte)] = UInt8(index)
+        }
+        for (index, byte) in "abcdef".utf8.enumerated() {
+            table[Int(byte)] = UInt8(10 + index)
+        }
+        return table
+    }()
+
+    /// Decodes a hex string (optionally with "0x" prefixes and spaces); `nil` if it is not valid hex.
+    ///
+    /// Invalid digits are not checked one by one: their 0xFF table entries are OR-ed together
+    /// and tested once at the end, so the loop has no data-dependent branches.
+    static func hexDecoded(_ hex: String) -> Data? {
+        var digits = Array(hex.utf8)
+        if digits.contains(where: { $0 == UInt8(ascii: "x") || $0 == UInt8(ascii: "X") || $0 == 0x20 }) {
+            digits = Array(hex.replacingOccurrences(of: "0x", with: "", options: .caseInsensitive).utf8)
+            digits.removeAll { $0 == 0x20 }
+        }
+        guard digits.count % 2 == 0 else {
+            return nil
+        }
+        var invalid: UInt8 = 0
+        var data = Data(count: digits.count / 2)
+        hexValues.withUnsafeBufferPointer { table in
+            digits.withUnsafeBufferPointer { digits in
+                data.withUnsafeMutableBytes { (output: UnsafeMutableRawBufferPointer) in
+                    for index in 0..<output.count {
+                        let high = table[Int(digits[2 * index])]
+                        let low = table[Int(digits[2 * index + 1])]
+                        invalid |= high | low
+                        output[index] = high << 4 | low
+                    }
+                }
+            }
+        }
+        return invalid & 0xF0 == 0 ? data : nil
+    }
+}
+
+/// A response (or intermediate message) from the terminal: the bytes between STX and ETX,
+/// tokenized on '|'. The payload is a slice of the parser's pooled buffer, not a copy.
+struct PosResponse {
+    let payload: FrameSlice
+    private let fieldRanges: [Range<Int>]
+
+    init(slice: FrameSlice) {
+        self.payload = slice
+        var ranges: [Range<Int>] = []
+        slice.withUnsafeBytes { bytes in
+            var start = 0
+            for index in 0..<bytes.count where bytes[index] == PosFrame.separator {
+                ranges.append(start..<index)
+                start = index + 1
+            }
+            ranges.append(start..<bytes.count)
+        }
+        self.fieldRanges = ranges
+    }
+
+    init<C: Collection>(payload: C) where C.Element == UInt8 {
+        let buffer = FrameBufferPool.shared.buffer(minimumCapacity: payload.count)
+        buffer.append(contentsOf: payload)
+        self.init(slice: buffer.bytes)
+    }
+
+    /// The message code, e.g. "0210" for a sale response.
+    var code: String {
+        return field(0) ?? ""
+    }
+
+    var fieldCount: Int {
+        return fieldRanges.count
+    }
+
+    /// Zero-copy bytes of field `index`.
+    func fieldBytes(_ index: Int) -> FrameSlice? {
+        guard index >= 0, index < fieldRanges.count else {
+            return nil
+        }
+        return payload.slice(fieldRanges[index])
+    }
+
+    func field(_ index: Int) -> String? {
+        return fieldBytes(index).map { String(decoding: $0, as: UTF8.self) }
+    }
+
+    /// Parsed straight from the bytes, with the same rules as `Int(String)`.
+    func integer(_ index: Int) -> Int? {
+        return fieldBytes(index)?.withUnsafeBytes { bytes -> Int? in
+            var digits = bytes[...]
+            let negative = digits.first == UInt8(ascii: "-")
+            if negative || digits.first == UInt8(ascii: "+") {
+                digits = digits.dropFirst()
+            }
+            guard !digits.isEmpty else {
+                return nil
+            }
+            var value = 0
+            for byte in digits {
+                let digit = Int(byte) &- 0x30
+                guard digit >= 0 && digit <= 9 else {
+                    return nil
+                }
+                let (shifted, overflow) = value.multipliedReportingOverflow(by: 10)
+                let (next, carry) = negative ? shifted.subtractingReportingOverflow(digit) : shifted.addingReportingOverflow(digit)
+                guard !overflow && !carry else {
+                    return nil
+                }
+                value = next
+            }
+            return value
+        }
+    }
+
+    var text: String {
+        return String(decoding: payload, as: UTF8.self)
+    }
+
+    var frame: Data {
+        return PosFrame.encode(payload: payload.data)
+    }
+}
+
+/// Incremental frame parser: bytes can arrive in any chunking and frames are emitted as soon
+/// as their LRC byte is received.
+///
+/// Payload bytes go into a pooled `FrameBuffer` and each frame is emitted as a slice of it.
+/// Frames are packed one after another in the buffer; without an `arena`, the buffer is
+/// rewound once no emitted slice is held any more. With an `arena`, buffers come from it and
+/// are never rewound, so every frame of the transaction lives in the arena's chunks.
+final class PosFrameParser {
+
+    enum Event {
+        case ack
+        case nak
+        case frame(PosResponse)
+        /// A frame whose LRC did not match or that exceeded `maximumFrameLength`.
+        case corrupted
+    }
+
+    let maximumFrameLength: Int
+    let pool: FrameBufferPool
+    /// Where the buffers of the following frames come from; usually the arena of the command in flight.
+    var arena: TransactionArena? {
+        didSet {
+            if arena !== oldValue {
+                relocate(minimumCapacity: frameLength + 256)
+            }
+        }
+    }
+
+    private var buffer: FrameBuffer
+    /// Offset in `buffer` of the frame being received.
+    private var frameStart = 0
+    private var inFrame = false
+    private var awaitingLRC = false
+    private var lrc: UInt8 = 0
+
+    init(maximumFrameLength: Int = 64 * 1024, pool: FrameBufferPool = .shared) {
+        self.maximumFrameLength = maximumFrameLength
+        self.pool = pool
+        self.buffer = pool.buffer()
+    }
+
+    func reset() {
+        buffer.truncate(to: frameStart)
+        if arena == nil && isKnownUniquelyReferenced(&buffer) {
+            buffer.removeAll()
+            frameStart = 0
+        }
+        inFrame = false
+        awaitingLRC = false
+        lrc = 0
+    }
+
+    private var frameLength: Int {
+        return buffer.count - frameStart
+    }
+
+    private func append(_ byte: UInt8) {
+        if buffer.count == buffer.capacity {
+            relocate(minimumCapacity: 2 * frameLength + 64)
+        }
+        buffer.append(byte)
+    }
+
+    /* El frame en curso se mueve a un buffer nuevo; los anteriores quedan donde están */
+    private func relocate(minimumCapacity: Int) {
+        let next = arena?.reserve(minimumCapacity: minimumCapacity) ?? pool.buffer(minimumCapacity: minimumCapacity)
+        next.append(contentsOf: buffer.slice(frameStart..<buffer.count))
+        buffer.truncate(to: frameStart)
+        buffer = next
+        frameStart = 0
+    }
+
+    private func emit() -> PosResponse {
+        let response = PosResponse(slice: buffer.slice(frameStart..<buffer.count))
+        frameStart = buffer.count
+        return response
+    }
+
+    func feed<C: Collection>(_ bytes: C) -> [Event] where C.Element == UInt8 {
+        var events: [Event] = []
+        for byte in bytes {
+            if awaitingLRC {
+                events.append(byte == lrc ? .frame(emit()) : .corrupted)
+                reset()
+            } else if inFrame {
+                lrc ^= byte
+                if byte == PosFrame.ETX {
+                    awaitingLRC = true
+                } else if byte == PosFrame.STX {
+                    events.append(.corrupted)
+                    reset()
+                    inFrame = true
+                } else if frameLength < maximumFrameLength {
+                    append(byte)
+                } else {
+                    events.append(.corrupted)
+                    reset()
+                }
+            } else if byte == PosFrame.STX {
+                inFrame = true
+            } else if byte == PosFrame.ACK {
+                events.append(.ack)
+            } else if byte == PosFrame.NAK {
+                events.append(.nak)
+            }
+        }
+        return events
+    }
+}
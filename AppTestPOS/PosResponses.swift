@@ -0,0 +1,311 @@
+//
+//  PosResponses.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// A terminal response with a fixed message code, decoded from its '|' separated fields.
+protocol PosResponseDecodable {
+    static var code: String { get }
+    init?(_ response: PosResponse)
+}
+
+/// Response 0210 to a sale (0200).
+struct SaleResponse: PosResponseDecodable {
+    static let code = "0210"
+
+    let responseCode: Int
+    let commerceCode: String
+    let terminalId: String
+    let ticket: String
+    let authorizationCode: String
+    let amount: Int
+    let sharesNumber: Int
+    let sharesAmount: Int
+    let last4Digits: String
+    let operationNumber: Int
+    let cardType: String
+    let accountingDate: String
+    let accountNumber: String
+    let cardBrand: String
+    let realDate: String
+    let realTime: String
+    let employeeId: String
+    let tip: Int
+    /// The frame this was decoded from; it keeps the transaction's arena alive until the sale
+    /// is dropped, normally once `SalesJournal.record` has written it.
+    let response: PosResponse
+
+    var isApproved: Bool {
+        return responseCode == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == SaleResponse.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.response = response
+        self.responseCode = responseCode
+        commerceCode = response.field(2) ?? ""
+        terminalId = response.field(3) ?? ""
+        ticket = response.field(4) ?? ""
+        authorizationCode = response.field(5) ?? ""
+        amount = response.integer(6) ?? 0
+        sharesNumber = response.integer(7) ?? 0
+        sharesAmount = response.integer(8) ?? 0
+        last4Digits = response.field(9) ?? ""
+        operationNumber = response.integer(10) ?? 0
+        cardType = response.field(11) ?? ""
+        accountingDate = response.field(12) ?? ""
+        accountNumber = response.field(13) ?? ""
+        cardBrand = response.field(14) ?? ""
+        realDate = response.field(15) ?? ""
+        realTime = response.field(16) ?? ""
+        employeeId = response.field(17) ?? ""
+        tip = response.integer(18) ?? 0
+    }
+}
+
+/// Response 1210 to a refund (1200).
+struct RefundResponse: PosResponseDecodable {
+    static let code = "1210"
+
+    let responseCode: Int
+    let commerceCode: String
+    let terminalId: String
+    let authorizationCode: String
+    let operationNumber: Int
+
+    var isApproved: Bool {
+        return responseCode == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == RefundResponse.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.responseCode = responseCode
+        commerceCode = response.field(2) ?? ""
+        terminalId = response.field(3) ?? ""
+        authorizationCode = response.field(4) ?? ""
+        operationNumber = response.integer(5) ?? 0
+    }
+}
+
+/// Response 0810 to a key load (0800).
+struct KeyLoadResponse: PosResponseDecodable {
+    static let code = "0810"
+
+    let responseCode: Int
+    let commerceCode: String
+    let terminalId: String
+
+    var isApproved: Bool {
+        return responseCode == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == KeyLoadResponse.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.responseCode = responseCode
+        commerceCode = response.field(2) ?? ""
+        terminalId = response.field(3) ?? ""
+    }
+}
+
+/// Response 0510 to a close (0500).
+struct CloseResponse: PosResponseDecodable {
+    static let code = "0510"
+
+    let responseCode: Int
+    let commerceCode: String
+    let terminalId: String
+
+    var isApproved: Bool {
+        return responseCode == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == CloseResponse.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.responseCode = responseCode
+        commerceCode = response.field(2) ?? ""
+        terminalId = response.field(3) ?? ""
+    }
+}
+
+/// Response 0710 to totals (0700): sales count and amount since the last close.
+struct TotalsResponse: PosResponseDecodable {
+    static let code = "0710"
+
+    let responseCode: Int
+    let transactionCount: Int
+    let transactionTotal: Int
+
+    var isApproved: Bool {
+        return responseCode == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == TotalsResponse.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.responseCode = responseCode
+        transactionCount = response.integer(2) ?? 0
+        transactionTotal = response.integer(3) ?? 0
+    }
+}
+
+/// One stored transaction of a details (0260) response.
+struct DetailRecord: PosResponseDecodable {
+    static let code = "0260"
+
+    let responseCode: Int
+    let commerceCode: String
+    let terminalId: String
+    let ticket: String
+    let authorizationCode: String
+    let amount: Int
+    let last4Digits: String
+    let operationNumber: Int
+    let cardType: String
+    let accountingDate: String
+    let accountNumber: String
+    let cardBrand: String
+    let realDate: String
+    let realTime: String
+    let employeeId: String
+    let tip: Int
+    let sharesAmount: Int
+    let sharesNumber: Int
+
+    /// The terminal ends the detail stream with a record without authorization code.
+    var isEndOfStream: Bool {
+        return authorizationCode.isEmpty && amount == 0
+    }
+
+    init?(_ response: PosResponse) {
+        guard response.code == DetailRecord.code, let responseCode = response.integer(1) else {
+            return nil
+        }
+        self.responseCode = responseCode
+        commerceCode = response.field(2) ?? ""
+        terminalId = response.field(3) ?? ""
+        ticket = response.field(4) ?? ""
+        authorizationCode = (response.field(5) ?? "").trimmingCharacters(in: .whitespaces)
+        amount = response.integer(6) ?? 0
+        last4Digits = response.field(7) ?? ""
+        operationNumber = response.integer(8) ?? 0
+        cardType = response.field(9) ?? ""
+        accountingDate = response.field(10) ?? ""
+        accountNumber = response.field(11) ?? ""
+        cardBrand = response.field(12) ?? ""
+        realDate = response.field(13) ?? ""
+        realTime = response.field(14) ?? ""
+        employeeId = response.field(15) ?? ""
+        tip = response.integer(16) ?? 0
+        sharesAmount = response.integer(17) ?? 0
+        sharesNumber = response.integer(18) ?? 0
+    }
+}
+
+extension TerminalSession {
+
+    /// Sends `command` and decodes the response as `R`; other message codes are not taken as the answer.
+    func request<R: PosResponseDecodable>(_ command: String, as type: R.Type,
+                                          timeout: TimeInterval = TerminalSession.defaultTimeout,
+                                          token: CancellationToken? = nil,
+                                          completion: @escaping (Result<R, PosError>) -> Void) {
+        send(command, expecting: R.code, timeout: timeout, token: token) { result in
+            completion(result.flatMap { response in
+                R(response).map { .success($0) } ?? .failure(.unexpectedResponse)
+            })
+        }
+    }
+
+    /// Sale for `amount`; `sendStatus` asks the terminal for 0900 intermediate messages.
+    func sale(amount: Int, ticket: String = "123456", sendStatus: Bool = false,
+              timeout: TimeInterval = TerminalSession.defaultTimeout, token: CancellationToken? = nil,
+              completion: @escaping (Result<SaleResponse, PosError>) -> Void) {
+        request("0200|\(amount)|\(ticket)|||\(sendStatus ? 1 : 0)", as: SaleResponse.self,
+                timeout: timeout, token: token, completion: completion)
+    }
+
+    func refund(operationNumber: Int, timeout: TimeInterval = TerminalSession.defaultTimeout,
+                token: CancellationToken? = nil, completion: @escaping (Result<RefundResponse, PosError>) -> Void) {
+        request("1200|\(operationNumber)|", as: RefundResponse.self, timeout: timeout, token: token, completion: completion)
+    }
+
+    func loadKeys(timeout: TimeInterval = TerminalSession.defaultTimeout, token: CancellationToken? = nil,
+                  completion: @escaping (Result<KeyLoadResponse, PosError>) -> Void) {
+        request("0800", as: KeyLoadResponse.self, timeout: timeout, token: token, completion: completion)
+    }
+
+    /// Close (0500); `printReport` asks the terminal to print the close voucher.
+    func close(printReport: Bool = false, timeout: TimeInterval = TerminalSession.defaultTimeout,
+               token: CancellationToken? = nil, completion: @escaping (Result<CloseResponse, PosError>) -> Void) {
+        request("0500|\(printReport ? 1 : 0)", as: CloseResponse.self, timeout: timeout, token: token, completion: completion)
+    }
+
+    func totals(timeout: TimeInterval = TerminalSession.defaultTimeout, token: CancellationToken? = nil,
+                completion: @escaping (Result<TotalsResponse, PosError>) -> Void) {
+        request("0700||", as: TotalsResponse.self, timeout: timeout, token: token, completion: completion)
+    }
+
+    /// Streams the details (0260) of the stored transactions one record at a time; `onRecord`
+    /// returns `false` to stop reading. `completion` gets the number of records delivered.
+    func details(printOnTerminal: Bool = false, timeout: TimeInterval = TerminalSession.defaultTimeout,
+                 token: CancellationToken? = nil, onRecord: @escaping (DetailRecord) -> Bool,
+                 completion: @escaping (Result<Int, PosError>) -> Void) {
+        var delivered = 0
+        stream("0260|\(printOnTerminal ? 0 : 1)", expecting: DetailRecord.code, timeout: timeout, token: token, isLast: { response in
+            DetailRecord(response)?.isEndOfStream ?? true
+        }, onFrame: { response in
+            guard let record = DetailRecord(response), !record.isEndOfStream else {
+                return false
+            }
+            delivered += 1
+            return onRecord(record)
+        }, completion: { result in
+            completion(result.map { _ in delivered })
+        })
+    }
+}
+
+/*Versiones async/await: cancelar la Task cancela el comando en la sesión*/
+@available(iOS 13.0, *)
+extension TerminalSession {
+
+    func request<R: PosResponseDecodable>(_ command: String, as type: R.Type,
+                                          timeout: TimeInterval = TerminalSession.defaultTimeout) async throws -> R {
+        let token = CancellationToken()
+        return try await withTaskCancellationHandler(handler: {
+            token.cancel()
+        }, operation: {
+            try await withCheckedThrowingContinuation { continuation in
+                self.request(command, as: type, timeout: timeout, token: token) { result in
+                    continuation.resume(with: result)
+                }
+            }
+        })
+    }
+
+    func sale(amount: Int, ticket: String = "123456", sendStatus: Bool = false,
+              timeout: TimeInterval = TerminalSession.defaultTimeout) async throws -> SaleResponse {
+        return try await request("0200|\(amount)|\(ticket)|||\(sendStatus ? 1 : 0)", as: SaleResponse.self, timeout: timeout)
+    }
+
+    func refund(operationNumber: Int, timeout: TimeInterval = TerminalSession.defaultTimeout) async throws -> RefundResponse {
+        return try await request("1200|\(operationNumber)|", as: RefundResponse.self, timeout: timeout)
+    }
+
+    func loadKeys(timeout: TimeInterval = TerminalSession.defaultTimeout) async throws -> KeyLoadResponse {
+        return try await request("0800", as: KeyLoadResponse.self, timeout: timeout)
+    }
+}
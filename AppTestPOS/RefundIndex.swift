@@ -0,0 +1,188 @@
+//
+//  RefundIndex.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Secondary index over past sales for finding the operation number to refund.
+///
+/// Rows are stored as columns; each searchable field has its own sorted column of
+/// `(key, row)` pairs. A query takes the row range of every predicate with binary search,
+/// then intersects the row lists smallest first, galloping through the larger ones. New sales
+/// are inserted in place, so one index can follow the journal for the whole period.
+struct RefundIndex {
+
+    struct Query {
+        var amount: ClosedRange<Int>?
+        var dates: ClosedRange<Date>?
+        var last4Digits: String?
+        var authorizationCode: String?
+        var terminal: String?
+
+        init(amount: ClosedRange<Int>? = nil, dates: ClosedRange<Date>? = nil, last4Digits: String? = nil,
+             authorizationCode: String? = nil, terminal: String? = nil) {
+            self.amount = amount
+            self.dates = dates
+            self.last4Digits = last4Digits
+            self.authorizationCode = authorizationCode
+            self.terminal = terminal
+        }
+    }
+
+    private struct SortedColumn<Key: Comparable> {
+        private(set) var keys: [Key]
+        private(set) var rows: [Int32]
+
+        init(_ values: [Key]) {
+            let order = values.indices.sorted { values[$0] < values[$1] }
+            keys = order.map { values[$0] }
+            rows = order.map { Int32($0) }
+        }
+
+        /// Adds `row` after the rows with an equal key.
+        mutating func insert(_ key: Key, row: Int32) {
+            let position = RefundIndex.lowerBound(keys) { $0 <= key }
+            keys.insert(key, at: position)
+            rows.insert(row, at: position)
+        }
+
+        /// Rows whose key is in `range`, sorted by row.
+        func rows(in range: ClosedRange<Key>) -> [Int32] {
+            let lower = RefundIndex.lowerBound(keys) { $0 < range.lowerBound }
+            let upper = RefundIndex.lowerBound(keys) { $0 <= range.upperBound }
+            guard lower < upper else {
+                return []
+            }
+            return rows[lower..<upper].sorted()
+        }
+    }
+
+    private(set) var entries: [SalesJournal.Entry]
+
+    private var amounts: SortedColumn<Int64>
+    private var times: SortedColumn<Double>
+    private var last4: SortedColumn<UInt16>
+    private var authorizations: SortedColumn<String>
+
+    init(_ entries: [SalesJournal.Entry] = []) {
+        self.entries = entries
+        amounts = SortedColumn(entries.map { Int64($0.amount) })
+        times = SortedColumn(entries.map { $0.date.timeIntervalSince1970 })
+        last4 = SortedColumn(entries.map { RefundIndex.last4Key($0.last4Digits) })
+        authorizations = SortedColumn(entries.map { RefundIndex.authorizationKey($0.authorizationCode) })
+    }
+
+    /// Adds one sale; O(log n) to place it plus the shift of each column.
+    mutating func insert(_ entry: SalesJournal.Entry) {
+        let row = Int32(entries.count)
+        entries.append(entry)
+        amounts.insert(Int64(entry.amount), row: row)
+        times.insert(entry.date.timeIntervalSince1970, row: row)
+        last4.insert(RefundIndex.last4Key(entry.last4Digits), row: row)
+        authorizations.insert(RefundIndex.authorizationKey(entry.authorizationCode), row: row)
+    }
+
+    private static func last4Key(_ digits: String) -> UInt16 {
+        return UInt16(digits.suffix(4)) ?? UInt16.max
+    }
+
+    private static func authorizationKey(_ code: String) -> String {
+        return code.trimmingCharacters(in: .whitespaces)
+    }
+
+    var count: Int {
+        return entries.count
+    }
+
+    /// Matching sales, most recent first.
+    func search(_ query: Query) -> [SalesJournal.Entry] {
+        var lists: [[Int32]] = []
+        if let amount = query.amount {
+            lists.append(amounts.rows(in: Int64(amount.lowerBound)...Int64(amount.upperBound)))
+        }
+        if let dates = query.dates {
+            lists.append(times.rows(in: dates.lowerBound.timeIntervalSince1970...dates.upperBound.timeIntervalSince1970))
+        }
+        if let digits = query.last4Digits {
+            guard let key = UInt16(digits) else {
+                return []
+            }
+            lists.append(last4.rows(in: key...key))
+        }
+        if let authorization = query.authorizationCode?.trimmingCharacters(in: .whitespaces) {
+            lists.append(authorizations.rows(in: authorization...authorization))
+        }
+
+        var rows: [Int32]
+        if lists.isEmpty {
+            rows = entries.indices.map { Int32($0) }
+        } else {
+            lists.sort { $0.count < $1.count }
+            rows = lists[0]
+            for list in lists.dropFirst() where !rows.isEmpty {
+                rows = RefundIndex.intersect(rows, list)
+            }
+        }
+        if let terminal = query.terminal {
+            rows = rows.filter { entries[Int($0)].terminal == terminal }
+        }
+        /* El orden de las filas es el de llegada, no el de la venta: se ordena por fecha */
+        return rows.map { entries[Int($0)] }.sorted { $0.date > $1.date }
+    }
+
+    /// First index whose key does not satisfy `isBefore`.
+    private static func lowerBound<Key>(_ keys: [Key], _ isBefore: (Key) -> Bool) -> Int {
+        var low = 0
+        var high = keys.count
+        while low < high {
+            let middle = (low + high) / 2
+            if isBefore(keys[middle]) {
+                low = middle + 1
+            } else {
+                high = middle
+            }
+        }
+        return low
+    }
+
+    /// Intersection of two sorted row lists; `small` is walked and `large` galloped through.
+    static func intersect(_ small: [Int32], _ large: [Int32]) -> [Int32] {
+        var result: [Int32] = []
+        result.reserveCapacity(small.count)
+        var position = 0
+        for row in small {
+            guard position < large.count else {
+                break
+            }
+            if large[position] < row {
+                var step = 1
+                var bound = position + 1
+                while bound < large.count && large[bound] < row {
+                    position = bound
+                    step *= 2
+                    bound = position + step
+                }
+                var low = position + 1
+                var high = min(bound, large.count)
+                while low < high {
+                    let middle = (low + high) / 2
+                    if large[middle] < row {
+                        low = middle + 1
+                    } else {
+                        high = middle
+                    }
+                }
+                position = low
+            }
+            if position < large.count && large[position] == row {
+                result.append(row)
+                position += 1
+            }
+        }
+        return result
+    }
+}
@@ -0,0 +1,205 @@
+//
+//  ScanAggregator.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import iSMP
+
+/// Collapses the barcode reader event stream into catalog requests.
+///
+/// Repeated reads of the same code inside `duplicateWindow` are dropped (the window slides
+/// while the code stays in front of the scanner), and scans made while the trigger is held,
+/// or closer than `burstGap` to each other, are delivered as a single batch.
+final class ScanAggregator {
+
+    struct SymbologyStats {
+        var decoded = 0
+        var rejected = 0
+        var duplicates = 0
+
+        var successRate: Double {
+            let total = decoded + rejected
+            return total == 0 ? 1 : Double(decoded) / Double(total)
+        }
+    }
+
+    var duplicateWindow: TimeInterval = 0.5
+    var burstGap: TimeInterval = 0.3
+    /// Called on `callbackQueue` with the scans of one burst, in scan order.
+    var onBatch: (([DecodedBarcode]) -> Void)?
+    var onRejected: ((Int32, BarcodeRejection) -> Void)?
+
+    let decoder: BarcodeDecoder
+    private let queue = DispatchQueue(label: "cl.transbank.scan-aggregator")
+    private let callbackQueue: DispatchQueue
+
+    private var triggerHeld = false
+    private var burst: [DecodedBarcode] = []
+    private var lastSeen: [String: TimeInterval] = [:]
+    private var stats: [Int32: SymbologyStats] = [:]
+    private var undecoded = 0
+    private var pendingFlush: DispatchWorkItem?
+
+    init(decoder: BarcodeDecoder = BarcodeDecoder(), callbackQueue: DispatchQueue = .main) {
+        self.decoder = decoder
+        self.callbackQueue = callbackQueue
+    }
+
+    func triggerPulled() {
+        queue.async {
+            self.triggerHeld = true
+            self.pendingFlush?.cancel()
+            self.pendingFlush = nil
+        }
+    }
+
+    func triggerReleased() {
+        queue.async {
+            self.triggerHeld = false
+            self.flush()
+        }
+    }
+
+    /// The reader saw a code but could not decode it; the symbology is unknown at this point.
+    func unsuccessfulDecode() {
+        queue.async {
+            self.undecoded += 1
+        }
+    }
+
+    func barcodeData(_ data: String, type: Int32) {
+        let now = ProcessInfo.processInfo.systemUptime
+        queue.async {
+            switch self.decoder.decode(data, type: type) {
+            case .failure(let rejection):
+                self.stats[type, default: SymbologyStats()].rejected += 1
+                if let onRejected = self.onRejected {
+                    self.callbackQueue.async { onRejected(type, rejection) }
+                }
+            case .success(let barcode):
+                self.accept(barcode, at: now)
+            }
+        }
+    }
+
+    /// Per symbology counters plus the reads that could not be decoded at all.
+    func statistics(_ completion: @escaping ([Int32: SymbologyStats], Int) -> Void) {
+        queue.async {
+            let stats = self.stats
+            let undecoded = self.undecoded
+            self.callbackQueue.async { completion(stats, undecoded) }
+        }
+    }
+
+    private func accept(_ barcode: DecodedBarcode, at time: TimeInterval) {
+        let identity = barcode.key.map { String($0) } ?? "\(barcode.symbology):\(barcode.data)"
+        let previous = lastSeen[identity]
+        lastSeen[identity] = time
+        if let previous = previous, time - previous < duplicateWindow {
+            stats[barcode.symbology, default: SymbologyStats()].duplicates += 1
+            return
+        }
+        stats[barcode.symbology, default: SymbologyStats()].decoded += 1
+        burst.append(barcode)
+
+        if !triggerHeld {
+            pendingFlush?.cancel()
+            let item = DispatchWorkItem { [weak self] in self?.flush() }
+            pendingFlush = item
+            queue.asyncAfter(deadline: .now() + burstGap, execute: item)
+        }
+    }
+
+    private func flush() {
+        pendingFlush?.cancel()
+        pendingFlush = nil
+
+        let now = ProcessInfo.processInfo.systemUptime
+        lastSeen = lastSeen.filter { now - $0.value < duplicateWindow }
+
+        guard !burst.isEmpty else {
+            return
+        }
+        let batch = burst
+        burst = []
+        if let onBatch = onBatch {
+            callbackQueue.async { onBatch(batch) }
+        }
+    }
+}
+
+/*Delegado del lector de códigos del terminal que alimenta al agregador*/
+final class BarcodeReaderAdapter: NSObject, ICISMPDeviceDelegate, ICBarCodeReaderDelegate {
+
+    let aggregator: ScanAggregator
+    /// Called on the SDK's thread when the scanner asks to be configured (after power on or a
+    /// reset); without it the scanner is put in multi scan so a held trigger gives one burst.
+    var onConfigurationRequest: ((ICBarCodeReader) -> Void)?
+    private(set) var reader: ICBarCodeReader?
+
+    init(aggregator: ScanAggregator) {
+        self.aggregator = aggregator
+    }
+
+    /// Becomes the reader's delegate (the reader only keeps it weakly) and powers the scanner on.
+    /// `powerOn` can take up to a second, so it runs off the main thread.
+    func attach(to reader: ICBarCodeReader) {
+        self.reader = reader
+        reader.delegate = self
+        DispatchQueue.global(qos: .userInitiated).async {
+            if reader.powerOn() != Int32(ICBarCodeReader_PowerOnSuccess.rawValue) {
+                print("Barcode reader power on failed")
+            }
+        }
+    }
+
+    func detach() {
+        guard let reader = reader else {
+            return
+        }
+        self.reader = nil
+        reader.delegate = nil
+        DispatchQueue.global(qos: .utility).async {
+            reader.powerOff()
+        }
+        aggregator.triggerReleased()
+    }
+
+    func barcodeData(_ data: Any!, ofType type: Int32) {
+        if let text = data as? String {
+            aggregator.barcodeData(text, type: type)
+        }
+    }
+
+    func configurationRequest() {
+        guard let reader = reader else {
+            return
+        }
+        if let onConfigurationRequest = onConfigurationRequest {
+            onConfigurationRequest(reader)
+        } else {
+            reader.configureBarCodeReaderMode(Int32(ICBarCodeScanMode_MultiScan.rawValue))
+        }
+    }
+
+    func unsuccessfulDecode() {
+        aggregator.unsuccessfulDecode()
+    }
+
+    func triggerPulled() {
+        aggregator.triggerPulled()
+    }
+
+    func triggerReleased() {
+        aggregator.triggerReleased()
+    }
+
+    /* Si se desconecta con el gatillo apretado, la ráfaga en curso se entrega igual */
+    func accessoryDidDisconnect(_ sender: ICISMPDevice!) {
+        aggregator.triggerReleased()
+    }
+}
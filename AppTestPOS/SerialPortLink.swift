@@ -0,0 +1,249 @@
+//
+//  SerialPortLink.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+#if canImport(Glibc)
+import Glibc
+#else
+import Darwin
+#endif
+
+/// Raw byte link over a serial device (a USB-serial adapter on a bench terminal) or a pty,
+/// with the same contract as `SPPLink`: the host ACK/NAKs frames and received bytes go
+/// through a `ByteRing` that the session drains in batches.
+///
+/// The descriptor is non-blocking and in termios raw mode at `baudRate`. Reads go straight
+/// into the ring's free space; when the ring is full, reading pauses until the session drains
+/// it. Only POSIX is used, so it works wherever the app can open the device: the simulator or
+/// a Mac host, not an iOS device, whose sandbox gives no access to `/dev`.
+final class SerialPortLink: BufferedPosLink {
+
+    enum SerialError: Error {
+        case open(path: String, errno: Int32)
+        case configure(errno: Int32)
+        case unsupportedBaudRate(Int)
+        case pseudoTerminal(errno: Int32)
+    }
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+    let acknowledgesFrames = true
+    let ring: ByteRing
+    let name: String
+
+    private let fd: Int32
+    private let ioQueue: DispatchQueue
+    private var reader: DispatchSourceRead?
+    private var writer: DispatchSourceWrite?
+    private var readerSuspended = false
+    private var output = Data()
+    private var readable: DispatchSourceUserDataOr?
+    private var isOpen = true
+
+    /// Opens `path` (e.g. "/dev/ttyUSB0", "/dev/cu.usbserial-1410" or a pty slave) in raw mode.
+    convenience init(path: String, baudRate: Int = 115_200, ringCapacity: Int = 64 * 1024) throws {
+        let fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK)
+        guard fd >= 0 else {
+            throw SerialError.open(path: path, errno: errno)
+        }
+        do {
+            try SerialPortLink.configure(fd, baudRate: baudRate)
+        } catch {
+            close(fd)
+            throw error
+        }
+        self.init(fileDescriptor: fd, name: path, ringCapacity: ringCapacity)
+    }
+
+    /// Takes ownership of an open, already configured descriptor (e.g. a pty master).
+    init(fileDescriptor fd: Int32, name: String, ringCapacity: Int = 64 * 1024) {
+        self.fd = fd
+        self.name = name
+        self.ring = ByteRing(capacity: ringCapacity)
+        self.ioQueue = DispatchQueue(label: "cl.transbank.serial.\(name)")
+        _ = fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK)
+
+        let reader = DispatchSource.makeReadSource(fileDescriptor: fd, queue: ioQueue)
+        reader.setEventHandler { [weak self] in
+            self?.readAvailable()
+        }
+        reader.setCancelHandler {
+            close(fd)
+        }
+        self.reader = reader
+        reader.resume()
+    }
+
+    deinit {
+        readable?.cancel()
+        writer?.cancel()
+        if readerSuspended {
+            reader?.resume()
+        }
+        reader?.cancel()
+    }
+
+    static let baudRates: [Int: speed_t] = [
+        9_600: speed_t(B9600),
+        19_200: speed_t(B19200),
+        38_400: speed_t(B38400),
+        57_600: speed_t(B57600),
+        115_200: speed_t(B115200),
+        230_400: speed_t(B230400),
+    ]
+
+    /// Raw mode (no echo, no line discipline, no flow control, 8N1) at `baudRate`; reads
+    /// return whatever is available.
+    static func configure(_ fd: Int32, baudRate: Int) throws {
+        guard let speed = baudRates[baudRate] else {
+            throw SerialError.unsupportedBaudRate(baudRate)
+        }
+        var options = termios()
+        guard tcgetattr(fd, &options) == 0 else {
+            throw SerialError.configure(errno: errno)
+        }
+        cfmakeraw(&options)
+        options.c_cflag |= tcflag_t(CLOCAL | CREAD)
+        options.c_cflag &= ~tcflag_t(CRTSCTS | CSTOPB)
+        withUnsafeMutableBytes(of: &options.c_cc) { cc in
+            cc[Int(VMIN)] = 0
+            cc[Int(VTIME)] = 0
+        }
+        guard cfsetispeed(&options, speed) == 0, cfsetospeed(&options, speed) == 0,
+              tcsetattr(fd, TCSANOW, &options) == 0 else {
+            throw SerialError.configure(errno: errno)
+        }
+        tcflush(fd, TCIOFLUSH)
+    }
+
+    /// Opens a pty pair in raw mode: the master descriptor and the slave's path, which a
+    /// `SerialPortLink(path:)` can open as if it were a serial device.
+    static func openPseudoTerminal() throws -> (master: Int32, slavePath: String) {
+        let master = posix_openpt(O_RDWR | O_NOCTTY)
+        guard master >= 0 else {
+            throw SerialError.pseudoTerminal(errno: errno)
+        }
+        guard grantpt(master) == 0, unlockpt(master) == 0, let name = ptsname(master) else {
+            let error = errno
+            close(master)
+            throw SerialError.pseudoTerminal(errno: error)
+        }
+        var options = termios()
+        if tcgetattr(master, &options) == 0 {
+            cfmakeraw(&options)
+            tcsetattr(master, TCSANOW, &options)
+        }
+        return (master, String(cString: name))
+    }
+
+    func deliver(on queue: DispatchQueue, readable handler: @escaping () -> Void) {
+        let source = DispatchSource.makeUserDataOrSource(queue: queue)
+        source.setEventHandler { [weak self] in
+            handler()
+            /* Con espacio libre en el ring se vuelve a leer del descriptor */
+            self?.ioQueue.async { self?.resumeReading() }
+        }
+        source.resume()
+        ioQueue.sync {
+            readable?.cancel()
+            readable = source
+            if ring.count > 0 {
+                source.or(data: 1)
+            }
+        }
+    }
+
+    func send(_ bytes: Data) {
+        ioQueue.async {
+            guard self.isOpen else {
+                return
+            }
+            self.output.append(bytes)
+            self.flush()
+        }
+    }
+
+    // MARK: - I/O queue
+
+    private func readAvailable() {
+        while isOpen {
+            let region = ring.writableRegion()
+            guard let base = region.baseAddress, region.count > 0 else {
+                /* Ring lleno: se deja de leer hasta que la sesión lo vacíe */
+                if !readerSuspended {
+                    readerSuspended = true
+                    reader?.suspend()
+                }
+                break
+            }
+            let count = read(fd, base, region.count)
+            if count > 0 {
+                ring.commit(count)
+                readable?.or(data: 1)
+            } else if count == 0 || (errno != EAGAIN && errno != EINTR) {
+                /* EOF o EIO: el otro extremo cerró (cable desconectado o pty cerrado) */
+                disconnect()
+                break
+            } else if errno == EAGAIN {
+                break
+            }
+        }
+    }
+
+    private func resumeReading() {
+        if readerSuspended && isOpen {
+            readerSuspended = false
+            reader?.resume()
+        }
+    }
+
+    private func flush() {
+        while !output.isEmpty {
+            let written = output.withUnsafeBytes { write(fd, $0.baseAddress, $0.count) }
+            if written > 0 {
+                output.removeFirst(written)
+            } else if written < 0 && errno == EINTR {
+                continue
+            } else if written < 0 && errno == EAGAIN {
+                /* Buffer del driver lleno: se continúa cuando el descriptor acepte más */
+                if writer == nil {
+                    let writer = DispatchSource.makeWriteSource(fileDescriptor: fd, queue: ioQueue)
+                    writer.setEventHandler { [weak self] in
+                        self?.flush()
+                    }
+                    self.writer = writer
+                    writer.resume()
+                }
+                return
+            } else {
+                disconnect()
+                return
+            }
+        }
+        writer?.cancel()
+        writer = nil
+    }
+
+    private func disconnect() {
+        guard isOpen else {
+            return
+        }
+        isOpen = false
+        output.removeAll()
+        writer?.cancel()
+        writer = nil
+        /* Cancelar el lector cierra el descriptor */
+        if readerSuspended {
+            readerSuspended = false
+            reader?.resume()
+        }
+        reader?.cancel()
+        reader = nil
+        onDisconnect?()
+    }
+}
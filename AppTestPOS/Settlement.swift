@@ -0,0 +1,415 @@
+//
+//  Settlement.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Host-side record of approved sales and refunds per terminal since its last close.
+///
+/// Kept as columns so reconciliation sums a contiguous `[Int64]`, and persisted as one
+/// '|' separated line per event: `S|terminal|operation|amount|authorization|last4|time` for a
+/// sale, the same with `R` and a negative amount for a refund, and `C|terminal|time` for a
+/// close. After a close the file is rewritten with only the periods still open.
+final class SalesJournal {
+
+    struct Entry {
+        let terminal: String
+        let operationNumber: Int
+        let amount: Int
+        let authorizationCode: String
+        let last4Digits: String
+        let date: Date
+
+        /// Refunds are journaled with the refunded sale's amount, negated.
+        var isRefund: Bool {
+            return amount < 0
+        }
+    }
+
+    private struct Columns {
+        var amounts: [Int64] = []
+        var entries: [Entry] = []
+        /// Entries that are sales, the count the terminal's 0710 reports.
+        var sales = 0
+    }
+
+    let url: URL?
+    private let queue = DispatchQueue(label: "cl.transbank.sales-journal")
+    private var terminals: [String: Columns] = [:]
+    /// Open sales of every terminal, for `refundableSales`.
+    private var refundIndex = RefundIndex()
+    private var handle: FileHandle?
+    private let lineBuffer = FrameBufferPool.shared.buffer()
+
+    init(url: URL? = SalesJournal.defaultURL()) {
+        self.url = url
+        guard let url = url else {
+            return
+        }
+        if let text = try? String(contentsOf: url, encoding: .utf8) {
+            for line in text.split(separator: "\n") {
+                replay(line.split(separator: "|", omittingEmptySubsequences: false))
+            }
+        } else {
+            FileManager.default.createFile(atPath: url.path, contents: nil)
+        }
+        handle = try? FileHandle(forWritingTo: url)
+        handle?.seekToEndOfFile()
+    }
+
+    static func defaultURL() -> URL {
+        let directory = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask)[0]
+        try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        return directory.appendingPathComponent("sales-journal.txt")
+    }
+
+    /// Journals an approved sale. The sale, and with it the arena of its transaction, is held
+    /// until its line has been written, and released right after.
+    func record(_ sale: SaleResponse, terminal: String, date: Date = Date()) {
+        guard sale.isApproved else {
+            return
+        }
+        queue.async {
+            let entry = Entry(terminal: terminal, operationNumber: sale.operationNumber, amount: sale.amount,
+                              authorizationCode: sale.authorizationCode, last4Digits: sale.last4Digits, date: date)
+            self.add(entry)
+            self.write(entry)
+        }
+    }
+
+    /// Journals an approved refund of sale `operationNumber` as a negative entry for the sale's
+    /// amount, so the period is net of refunds like the terminal's totals. A sale from before the
+    /// last close is no longer in the journal and its refund is not recorded.
+    func recordRefund(_ refund: RefundResponse, of operationNumber: Int, terminal: String, date: Date = Date()) {
+        guard refund.isApproved else {
+            return
+        }
+        queue.async {
+            guard let sale = self.terminals[terminal]?.entries.first(where: { $0.operationNumber == operationNumber && !$0.isRefund }) else {
+                return
+            }
+            let entry = Entry(terminal: terminal, operationNumber: operationNumber, amount: -sale.amount,
+                              authorizationCode: refund.authorizationCode, last4Digits: sale.last4Digits, date: date)
+            self.add(entry)
+            self.write(entry)
+        }
+    }
+
+    /// Stores the compressed signature of a sale (`SignatureRecorder.archive()`) next to the
+    /// journal, as `signatures/<terminal>-<operation>.sig`; kept across closes.
+    func attachSignature(_ archive: Data, terminal: String, operationNumber: Int) {
+        guard let url = signatureURL(terminal: terminal, operationNumber: operationNumber) else {
+            return
+        }
+        queue.async {
+            try? FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+            try? archive.write(to: url, options: .atomic)
+        }
+    }
+
+    func signature(terminal: String, operationNumber: Int) -> Data? {
+        guard let url = signatureURL(terminal: terminal, operationNumber: operationNumber) else {
+            return nil
+        }
+        return queue.sync { try? Data(contentsOf: url) }
+    }
+
+    private func signatureURL(terminal: String, operationNumber: Int) -> URL? {
+        return url?.deletingLastPathComponent().appendingPathComponent("signatures")
+            .appendingPathComponent("\(terminal)-\(operationNumber).sig")
+    }
+
+    /// Starts a new settlement period for `terminal`.
+    func closed(_ terminal: String, date: Date = Date()) {
+        queue.async {
+            self.terminals[terminal] = nil
+            self.rebuildRefundIndex()
+            self.lineBuffer.removeAll()
+            SalesJournal.appendClose(terminal, date: date, to: self.lineBuffer)
+            self.flushLine()
+            self.compact()
+        }
+    }
+
+    func entries(_ terminal: String) -> [Entry] {
+        return queue.sync { terminals[terminal]?.entries ?? [] }
+    }
+
+    /// Every open entry, all terminals, oldest first.
+    var allEntries: [Entry] {
+        return queue.sync { terminals.values.flatMap { $0.entries }.sorted { $0.date < $1.date } }
+    }
+
+    /// Open sales matching `query`, most recent first, from the index kept with the journal.
+    func refundableSales(_ query: RefundIndex.Query) -> [Entry] {
+        return queue.sync { refundIndex.search(query) }
+    }
+
+    /// Sale count and amount net of refunds since the last close of `terminal`.
+    func totals(_ terminal: String) -> (count: Int, amount: Int64) {
+        return queue.sync {
+            guard let columns = terminals[terminal] else {
+                return (0, 0)
+            }
+            return (columns.sales, SalesJournal.sum(columns.amounts))
+        }
+    }
+
+    /// Sum four lanes at a time; the tail is added separately.
+    static func sum(_ values: [Int64]) -> Int64 {
+        return values.withUnsafeBufferPointer { buffer -> Int64 in
+            var lanes = SIMD4<Int64>(repeating: 0)
+            var index = 0
+            while index + 4 <= buffer.count {
+                lanes &+= SIMD4<Int64>(buffer[index], buffer[index + 1], buffer[index + 2], buffer[index + 3])
+                index += 4
+            }
+            var total = lanes.wrappedSum()
+            while index < buffer.count {
+                total &+= buffer[index]
+                index += 1
+            }
+            return total
+        }
+    }
+
+    private func add(_ entry: Entry) {
+        terminals[entry.terminal, default: Columns()].amounts.append(Int64(entry.amount))
+        terminals[entry.terminal, default: Columns()].entries.append(entry)
+        if !entry.isRefund {
+            terminals[entry.terminal, default: Columns()].sales += 1
+            refundIndex.insert(entry)
+        }
+    }
+
+    private func rebuildRefundIndex() {
+        refundIndex = RefundIndex(terminals.values.flatMap { $0.entries }.filter { !$0.isRefund }.sorted { $0.date < $1.date })
+    }
+
+    /* Las líneas se arman byte a byte en el buffer, sin pasar por String */
+    private static func append(_ entry: Entry, to buffer: FrameBuffer) {
+        buffer.append(entry.isRefund ? UInt8(ascii: "R") : UInt8(ascii: "S"))
+        buffer.append(UInt8(ascii: "|"))
+        buffer.append(contentsOf: entry.terminal.utf8)
+        buffer.append(UInt8(ascii: "|"))
+        appendDecimal(Int64(entry.operationNumber), to: buffer)
+        buffer.append(UInt8(ascii: "|"))
+        appendDecimal(Int64(entry.amount), to: buffer)
+        buffer.append(UInt8(ascii: "|"))
+        buffer.append(contentsOf: entry.authorizationCode.utf8)
+        buffer.append(UInt8(ascii: "|"))
+        buffer.append(contentsOf: entry.last4Digits.utf8)
+        buffer.append(UInt8(ascii: "|"))
+        appendTime(entry.date, to: buffer)
+        buffer.append(0x0A)
+    }
+
+    private static func appendClose(_ terminal: String, date: Date, to buffer: FrameBuffer) {
+        buffer.append(UInt8(ascii: "C"))
+        buffer.append(UInt8(ascii: "|"))
+        buffer.append(contentsOf: terminal.utf8)
+        buffer.append(UInt8(ascii: "|"))
+        appendTime(date, to: buffer)
+        buffer.append(0x0A)
+    }
+
+    private static func appendDecimal(_ value: Int64, to buffer: FrameBuffer, minimumDigits: Int = 1) {
+        if value < 0 {
+            buffer.append(UInt8(ascii: "-"))
+        }
+        let magnitude = value.magnitude
+        var divisor: UInt64 = 1
+        var digits = 1
+        while digits < minimumDigits || magnitude / divisor >= 10 {
+            divisor *= 10
+            digits += 1
+        }
+        while divisor > 0 {
+            buffer.append(UInt8(ascii: "0") + UInt8(magnitude / divisor % 10))
+            divisor /= 10
+        }
+    }
+
+    /// Seconds since 1970 with six decimals; `replay` reads it back as a `Double`.
+    private static func appendTime(_ date: Date, to buffer: FrameBuffer) {
+        let microseconds = Int64((date.timeIntervalSince1970 * 1_000_000).rounded())
+        if microseconds < 0 {
+            buffer.append(UInt8(ascii: "-"))
+        }
+        appendDecimal(Int64(microseconds.magnitude / 1_000_000), to: buffer)
+        buffer.append(UInt8(ascii: "."))
+        appendDecimal(Int64(microseconds.magnitude % 1_000_000), to: buffer, minimumDigits: 6)
+    }
+
+    /* Tras un cierre el archivo se reescribe con los períodos abiertos; si falla, queda el registro C */
+    private func compact() {
+        guard let url = url else {
+            return
+        }
+        let buffer = FrameBufferPool.shared.buffer(minimumCapacity: 64 * 1024)
+        for entry in terminals.values.flatMap({ $0.entries }).sorted(by: { $0.date < $1.date }) {
+            SalesJournal.append(entry, to: buffer)
+        }
+        do {
+            try buffer.bytes.data.write(to: url, options: .atomic)
+        } catch {
+            print("SalesJournal: compaction failed (\(error))")
+            return
+        }
+        handle?.closeFile()
+        handle = try? FileHandle(forWritingTo: url)
+        handle?.seekToEndOfFile()
+    }
+
+    /* El buffer de línea se reutiliza: solo se toca desde `queue` */
+    private func write(_ entry: Entry) {
+        lineBuffer.removeAll()
+        SalesJournal.append(entry, to: lineBuffer)
+        flushLine()
+    }
+
+    private func flushLine() {
+        lineBuffer.bytes.withUnsafeBytes { bytes in
+            guard let base = bytes.baseAddress else { return }
+            handle?.write(Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: base), count: bytes.count, deallocator: .none))
+        }
+    }
+
+    private func replay(_ fields: [Substring]) {
+        switch fields.first {
+        case "S"? where fields.count == 7, "R"? where fields.count == 7:
+            guard let operation = Int(fields[2]), let amount = Int(fields[3]), let time = Double(fields[6]) else {
+                return
+            }
+            add(Entry(terminal: String(fields[1]), operationNumber: operation, amount: amount,
+                      authorizationCode: String(fields[4]), last4Digits: String(fields[5]),
+                      date: Date(timeIntervalSince1970: time)))
+        case "C"? where fields.count == 3:
+            terminals[String(fields[1])] = nil
+            rebuildRefundIndex()
+        default:
+            break
+        }
+    }
+}
+
+/// Outcome of settling one terminal.
+struct SettlementReport {
+    let terminal: String
+    let totals: TotalsResponse?
+    let journalCount: Int
+    let journalAmount: Int64
+    let close: CloseResponse?
+    /// Why totals or close failed; alongside a `close` it is the totals error, the close having
+    /// been sent without reconciliation.
+    let error: PosError?
+
+    /// The terminal's totals match the journal.
+    var isReconciled: Bool {
+        guard let totals = totals, totals.isApproved else {
+            return false
+        }
+        return totals.transactionCount == journalCount && Int64(totals.transactionTotal) == journalAmount
+    }
+
+    var isClosed: Bool {
+        return close?.isApproved ?? false
+    }
+}
+
+/// End-of-day settlement across every session: totals (0700), reconciliation against the
+/// journal, then close (0500), with at most `maximumConcurrent` terminals in progress at once.
+/// A requested close is sent even when the totals fail; the report then has no reconciliation.
+final class SettlementEngine {
+
+    let journal: SalesJournal
+    var maximumConcurrent = 8
+    /// Close terminals whose totals do not match the journal (the mismatch is still reported).
+    var closeUnreconciled = false
+
+    private let queue = DispatchQueue(label: "cl.transbank.settlement")
+
+    init(journal: SalesJournal) {
+        self.journal = journal
+    }
+
+    /// `completion` runs on the engine's queue with one report per session, in session order.
+    func settle(_ sessions: [TerminalSession], close: Bool = true, token: CancellationToken? = nil,
+                completion: @escaping ([SettlementReport]) -> Void) {
+        queue.async {
+            var reports = [SettlementReport?](repeating: nil, count: sessions.count)
+            var next = 0
+            var running = 0
+
+            func pump() {
+                while running < self.maximumConcurrent && next < sessions.count {
+                    let index = next
+                    next += 1
+                    running += 1
+                    self.settle(sessions[index], close: close, token: token) { report in
+                        self.queue.async {
+                            reports[index] = report
+                            running -= 1
+                            pump()
+                        }
+                    }
+                }
+                if running == 0 && next == sessions.count {
+                    completion(reports.compactMap { $0 })
+                }
+            }
+            pump()
+        }
+    }
+
+    private func settle(_ session: TerminalSession, close: Bool, token: CancellationToken?,
+                        completion: @escaping (SettlementReport) -> Void) {
+        let terminal = session.identifier
+        session.totals(token: token) { result in
+            let journal = self.journal.totals(terminal)
+            func report(_ totals: TotalsResponse?, _ close: CloseResponse?, _ error: PosError?) -> SettlementReport {
+                return SettlementReport(terminal: terminal, totals: totals, journalCount: journal.count,
+                                        journalAmount: journal.amount, close: close, error: error)
+            }
+
+            switch result {
+            case .failure(let error) where !close:
+                completion(report(nil, nil, error))
+            case .failure(let error):
+                /* Sin totales no hay conciliación, pero el cierre pedido se envía igual */
+                session.close(token: token) { result in
+                    switch result {
+                    case .failure(let closeError):
+                        completion(report(nil, nil, closeError))
+                    case .success(let closeResponse):
+                        if closeResponse.isApproved {
+                            self.journal.closed(terminal)
+                        }
+                        completion(report(nil, closeResponse, error))
+                    }
+                }
+            case .success(let totals):
+                let reconciled = report(totals, nil, nil)
+                guard close, reconciled.isReconciled || self.closeUnreconciled else {
+                    completion(reconciled)
+                    return
+                }
+                session.close(token: token) { result in
+                    switch result {
+                    case .failure(let error):
+                        completion(report(totals, nil, error))
+                    case .success(let closeResponse):
+                        if closeResponse.isApproved {
+                            self.journal.closed(terminal)
+                        }
+                        completion(report(totals, closeResponse, nil))
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,257 @@
+//
+//  SignatureCapture.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import UIKit
+import Compression
+import iSMP
+
+/// Records a signature as polylines relative to the capture rectangle requested by the terminal.
+///
+/// Points are kept as small integer vectors and only rasterized when the signature is submitted,
+/// so the bitmap sent through `submitSignatureWithImage:` is exactly the requested size.
+final class SignatureRecorder {
+
+    struct Point: Equatable {
+        var x: Int16
+        var y: Int16
+    }
+
+    let width: Int
+    let height: Int
+    let timeout: TimeInterval
+
+    private(set) var strokes: [[Point]] = []
+
+    init(signatureData: ICSignatureData) {
+        width = max(1, Int(signatureData.screenWidth))
+        height = max(1, Int(signatureData.screenHeight))
+        timeout = TimeInterval(signatureData.userSignTimeout)
+    }
+
+    init(width: Int, height: Int, timeout: TimeInterval = 0) {
+        self.width = max(1, width)
+        self.height = max(1, height)
+        self.timeout = timeout
+    }
+
+    var isEmpty: Bool {
+        return strokes.isEmpty
+    }
+
+    func beginStroke(at location: CGPoint) {
+        strokes.append([clamp(location)])
+    }
+
+    func addPoint(_ location: CGPoint) {
+        guard !strokes.isEmpty else {
+            beginStroke(at: location)
+            return
+        }
+        let point = clamp(location)
+        if strokes[strokes.count - 1].last != point {
+            strokes[strokes.count - 1].append(point)
+        }
+    }
+
+    func clear() {
+        strokes.removeAll()
+    }
+
+    /// Simplifies every stroke with Ramer–Douglas–Peucker; `tolerance` is in capture pixels.
+    func simplify(tolerance: Double = 1.0) {
+        strokes = strokes.map { SignatureRecorder.simplify($0, tolerance: tolerance) }
+    }
+
+    /// Draws the strokes in black over white at the exact capture size (scale 1).
+    func rasterize(lineWidth: CGFloat = 2) -> UIImage {
+        let format = UIGraphicsImageRendererFormat.default()
+        format.scale = 1
+        format.opaque = true
+        let renderer = UIGraphicsImageRenderer(size: CGSize(width: width, height: height), format: format)
+        return renderer.image { context in
+            UIColor.white.setFill()
+            context.fill(CGRect(x: 0, y: 0, width: width, height: height))
+
+            let path = UIBezierPath()
+            path.lineWidth = lineWidth
+            path.lineCapStyle = .round
+            path.lineJoinStyle = .round
+            for stroke in strokes {
+                guard let first = stroke.first else { continue }
+                path.move(to: CGPoint(x: CGFloat(first.x), y: CGFloat(first.y)))
+                if stroke.count == 1 {
+                    path.addLine(to: CGPoint(x: CGFloat(first.x) + 0.5, y: CGFloat(first.y)))
+                }
+                for point in stroke.dropFirst() {
+                    path.addLine(to: CGPoint(x: CGFloat(point.x), y: CGFloat(point.y)))
+                }
+            }
+            UIColor.black.setStroke()
+            path.stroke()
+        }
+    }
+
+    /// Delta-encoded polyline: "SIG1", width, height, then per stroke its point count,
+    /// the first point and the zigzag varint deltas of the following points.
+    func encoded() -> Data {
+        var data = Data("SIG1".utf8)
+        SignatureRecorder.appendVarint(UInt64(width), to: &data)
+        SignatureRecorder.appendVarint(UInt64(height), to: &data)
+        SignatureRecorder.appendVarint(UInt64(strokes.count), to: &data)
+        for stroke in strokes {
+            SignatureRecorder.appendVarint(UInt64(stroke.count), to: &data)
+            var previous = Point(x: 0, y: 0)
+            for point in stroke {
+                SignatureRecorder.appendVarint(SignatureRecorder.zigzag(Int(point.x) - Int(previous.x)), to: &data)
+                SignatureRecorder.appendVarint(SignatureRecorder.zigzag(Int(point.y) - Int(previous.y)), to: &data)
+                previous = point
+            }
+        }
+        return data
+    }
+
+    /// The encoded polyline compressed with zlib, for archival next to the transaction.
+    func archive() -> Data? {
+        let source = encoded()
+        var destination = Data(count: source.count + 64)
+        let written = destination.withUnsafeMutableBytes { (output: UnsafeMutableRawBufferPointer) -> Int in
+            source.withUnsafeBytes { (input: UnsafeRawBufferPointer) -> Int in
+                guard let outputBase = output.bindMemory(to: UInt8.self).baseAddress,
+                    let inputBase = input.bindMemory(to: UInt8.self).baseAddress else {
+                    return 0
+                }
+                return compression_encode_buffer(outputBase, output.count, inputBase, input.count, nil, COMPRESSION_ZLIB)
+            }
+        }
+        guard written > 0 else {
+            return nil
+        }
+        destination.count = written
+        return destination
+    }
+
+    private func clamp(_ location: CGPoint) -> Point {
+        let x = min(max(Int(location.x.rounded()), 0), width - 1)
+        let y = min(max(Int(location.y.rounded()), 0), height - 1)
+        return Point(x: Int16(clamping: x), y: Int16(clamping: y))
+    }
+
+    private static func simplify(_ stroke: [Point], tolerance: Double) -> [Point] {
+        guard stroke.count > 2 else {
+            return stroke
+        }
+        var keep = [Bool](repeating: false, count: stroke.count)
+        keep[0] = true
+        keep[stroke.count - 1] = true
+
+        var ranges = [(0, stroke.count - 1)]
+        let toleranceSquared = tolerance * tolerance
+        while let (first, last) = ranges.popLast() {
+            guard last - first > 1 else { continue }
+            let ax = Double(stroke[first].x), ay = Double(stroke[first].y)
+            let dx = Double(stroke[last].x) - ax, dy = Double(stroke[last].y) - ay
+            let lengthSquared = dx * dx + dy * dy
+
+            var farthest = first
+            var farthestDistance = 0.0
+            for index in (first + 1)..<last {
+                let px = Double(stroke[index].x) - ax, py = Double(stroke[index].y) - ay
+                let distance: Double
+                if lengthSquared == 0 {
+                    distance = px * px + py * py
+                } else {
+                    let cross = px * dy - py * dx
+                    distance = cross * cross / lengthSquared
+                }
+                if distance > farthestDistance {
+                    farthestDistance = distance
+                    farthest = index
+                }
+            }
+            if farthestDistance > toleranceSquared {
+                keep[farthest] = true
+                ranges.append((first, farthest))
+                ranges.append((farthest, last))
+            }
+        }
+        return stroke.indices.filter { keep[$0] }.map { stroke[$0] }
+    }
+
+    private static func zigzag(_ value: Int) -> UInt64 {
+        return UInt64(bitPattern: Int64(value << 1) ^ Int64(value >> 63))
+    }
+
+    private static func appendVarint(_ value: UInt64, to data: inout Data) {
+        var value = value
+        while value >= 0x80 {
+            data.append(UInt8(value & 0x7F) | 0x80)
+            value >>= 7
+        }
+        data.append(UInt8(value))
+    }
+}
+
+/*Vista para capturar la firma en el rectángulo pedido por el terminal*/
+final class SignatureView: UIView {
+
+    let recorder: SignatureRecorder
+    var onSubmit: ((SignatureRecorder) -> Void)?
+
+    private let strokeLayer = CAShapeLayer()
+    private let path = UIBezierPath()
+
+    init(recorder: SignatureRecorder, frame: CGRect) {
+        self.recorder = recorder
+        super.init(frame: frame)
+        backgroundColor = UIColor.white
+        layer.borderColor = UIColor.lightGray.cgColor
+        layer.borderWidth = 1
+
+        strokeLayer.strokeColor = UIColor.black.cgColor
+        strokeLayer.fillColor = nil
+        strokeLayer.lineWidth = 2
+        strokeLayer.lineCap = .round
+        strokeLayer.lineJoin = .round
+        layer.addSublayer(strokeLayer)
+
+        let acceptButton = UIButton(type: .system)
+        acceptButton.setTitle("Aceptar", for: .normal)
+        acceptButton.addTarget(self, action: #selector(accept), for: .touchUpInside)
+        acceptButton.translatesAutoresizingMaskIntoConstraints = false
+        addSubview(acceptButton)
+        addConstraints([
+            NSLayoutConstraint(item: acceptButton, attribute: .trailing, relatedBy: .equal, toItem: self, attribute: .trailing, multiplier: 1, constant: -8),
+            NSLayoutConstraint(item: acceptButton, attribute: .bottom, relatedBy: .equal, toItem: self, attribute: .bottom, multiplier: 1, constant: -4)
+        ])
+    }
+
+    required init?(coder aDecoder: NSCoder) {
+        fatalError("init(coder:) has not been implemented")
+    }
+
+    override func touchesBegan(_ touches: Set<UITouch>, with event: UIEvent?) {
+        guard let location = touches.first?.location(in: self) else { return }
+        recorder.beginStroke(at: location)
+        path.move(to: location)
+        strokeLayer.path = path.cgPath
+    }
+
+    override func touchesMoved(_ touches: Set<UITouch>, with event: UIEvent?) {
+        guard let touch = touches.first else { return }
+        for location in (event?.coalescedTouches(for: touch) ?? [touch]).map({ $0.location(in: self) }) {
+            recorder.addPoint(location)
+            path.addLine(to: location)
+        }
+        strokeLayer.path = path.cgPath
+    }
+
+    @objc private func accept() {
+        guard !recorder.isEmpty else { return }
+        onSubmit?(recorder)
+    }
+}
@@ -0,0 +1,238 @@
+//
+//  TCPLink.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import Network
+import Security
+import iSMP
+
+/// Client certificate and trust anchors for `TCPLink`: the PKCS#12 file named by
+/// `ICSSLParameters.sslCertificateName` and the CA certificate `terminal-ca.der`, both in the
+/// app bundle.
+struct TLSSettings {
+
+    enum LoadError: Error {
+        /// The PKCS#12 file is not in the bundle or cannot be read.
+        case missingCertificate(String)
+        /// `SecPKCS12Import` failed, e.g. with a wrong password.
+        case importFailed(OSStatus)
+        /// The PKCS#12 file holds no identity.
+        case noIdentity(String)
+        /// The CA file is not a DER certificate.
+        case invalidAnchor(String)
+    }
+
+    /// Bundled CA that signs the terminals' certificates.
+    static let anchorResource = "terminal-ca"
+
+    let identity: SecIdentity?
+    /// Certificates accepted as roots for the terminal's certificate; empty means the system roots.
+    let anchors: [SecCertificate]
+
+    init(identity: SecIdentity?, anchors: [SecCertificate]) {
+        self.identity = identity
+        self.anchors = anchors
+    }
+
+    /// `nil` when SSL is off. Throws when the client identity cannot be loaded, so the link is
+    /// never opened without it. Without `terminal-ca.der` in the bundle the system roots apply.
+    init?(_ ssl: ICSSLParameters, bundle: Bundle = .main) throws {
+        guard ssl.isSSL else {
+            return nil
+        }
+        let identity = try TLSSettings.identity(named: ssl.sslCertificateName ?? "",
+                                                password: ssl.sslCertificatePassword ?? "", bundle: bundle)
+        self.init(identity: identity, anchors: try TLSSettings.anchors(named: TLSSettings.anchorResource, bundle: bundle))
+    }
+
+    /// The identity in the PKCS#12 file `name`.p12 of `bundle`.
+    static func identity(named name: String, password: String, bundle: Bundle = .main) throws -> SecIdentity {
+        guard let url = bundle.url(forResource: name, withExtension: "p12"),
+              let data = try? Data(contentsOf: url) else {
+            throw LoadError.missingCertificate(name)
+        }
+        var items: CFArray?
+        let options = [kSecImportExportPassphrase as String: password]
+        let status = SecPKCS12Import(data as CFData, options as CFDictionary, &items)
+        guard status == errSecSuccess else {
+            throw LoadError.importFailed(status)
+        }
+        guard let item = (items as? [[String: Any]])?.first,
+              let identity = item[kSecImportItemIdentity as String].map({ $0 as! SecIdentity }) else {
+            throw LoadError.noIdentity(name)
+        }
+        return identity
+    }
+
+    /* La CA de los terminales va en su propio archivo: un p12 con solo la hoja no trae cadena */
+    static func anchors(named name: String, bundle: Bundle = .main) throws -> [SecCertificate] {
+        guard let url = bundle.url(forResource: name, withExtension: "der") else {
+            return []
+        }
+        guard let data = try? Data(contentsOf: url),
+              let certificate = SecCertificateCreateWithData(nil, data as CFData) else {
+            throw LoadError.invalidAnchor(url.lastPathComponent)
+        }
+        return [certificate]
+    }
+}
+
+/// Framed protocol over TCP to a terminal reachable at `ICTerminal.ipAddress`.
+///
+/// The host ACK/NAKs frames itself. Nagle is off so single-frame commands and the ACK/NAK
+/// bytes leave at once, and the connection stays open between commands: it is only opened
+/// on the first send and reopened on the next send after it drops. With TLS, session tickets
+/// (and, from iOS 13, session resumption) are enabled, so a reconnect resumes the previous
+/// session instead of doing a full handshake.
+@available(iOS 12.0, *)
+final class TCPLink: PosLink {
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+    let acknowledgesFrames = true
+
+    let host: String
+    let port: UInt16
+    let tls: TLSSettings?
+    private(set) var connectionsOpened = 0
+
+    private let queue: DispatchQueue
+    private var connection: NWConnection?
+    private var isReady = false
+    /// Frames sent while the connection is being established.
+    private var pending: [Data] = []
+
+    init(host: String, port: UInt16, tls: TLSSettings? = nil) {
+        self.host = host
+        self.port = port
+        self.tls = tls
+        self.queue = DispatchQueue(label: "cl.transbank.tcp.\(host):\(port)")
+    }
+
+    /// `nil` for Bluetooth terminals and terminals without an IP address; throws the
+    /// `TLSSettings.LoadError` when SSL is on and the client certificate cannot be loaded.
+    convenience init?(terminal: ICTerminal, port: UInt16, ssl: ICSSLParameters) throws {
+        guard !terminal.isBluetooth, let address = terminal.ipAddress, !address.isEmpty else {
+            return nil
+        }
+        self.init(host: address, port: port, tls: try TLSSettings(ssl))
+    }
+
+    deinit {
+        connection?.cancel()
+    }
+
+    func send(_ bytes: Data) {
+        queue.async {
+            let connection = self.connection ?? self.connect()
+            if self.isReady {
+                connection.send(content: bytes, completion: .contentProcessed { _ in })
+            } else {
+                self.pending.append(bytes)
+            }
+        }
+    }
+
+    /// Closes the connection without reporting a disconnect; the next send opens a new one.
+    func close() {
+        queue.async {
+            if let connection = self.connection {
+                self.detach(connection)
+            }
+        }
+    }
+
+    private func parameters() -> NWParameters {
+        let tcp = NWProtocolTCP.Options()
+        tcp.noDelay = true
+        tcp.enableKeepalive = true
+        tcp.keepaliveIdle = 30
+        tcp.connectionTimeout = 10
+        guard let settings = tls else {
+            return NWParameters(tls: nil, tcp: tcp)
+        }
+        let options = NWProtocolTLS.Options()
+        let security = options.securityProtocolOptions
+        sec_protocol_options_set_tls_tickets_enabled(security, true)
+        if #available(iOS 13.0, *) {
+            sec_protocol_options_set_tls_resumption_enabled(security, true)
+        }
+        if let identity = settings.identity, let local = sec_identity_create(identity) {
+            sec_protocol_options_set_local_identity(security, local)
+        }
+        if !settings.anchors.isEmpty {
+            let anchors = settings.anchors
+            sec_protocol_options_set_verify_block(security, { _, trust, complete in
+                let trust = sec_trust_copy_ref(trust).takeRetainedValue()
+                SecTrustSetAnchorCertificates(trust, anchors as CFArray)
+                SecTrustSetAnchorCertificatesOnly(trust, true)
+                complete(SecTrustEvaluateWithError(trust, nil))
+            }, queue)
+        }
+        return NWParameters(tls: options, tcp: tcp)
+    }
+
+    private func connect() -> NWConnection {
+        let connection = NWConnection(host: NWEndpoint.Host(host), port: NWEndpoint.Port(rawValue: port) ?? 0,
+                                      using: parameters())
+        self.connection = connection
+        connectionsOpened += 1
+        connection.stateUpdateHandler = { [weak self, weak connection] state in
+            guard let self = self, let connection = connection, connection === self.connection else {
+                return
+            }
+            switch state {
+            case .ready:
+                self.isReady = true
+                for bytes in self.pending {
+                    connection.send(content: bytes, completion: .contentProcessed { _ in })
+                }
+                self.pending.removeAll()
+            case .failed, .cancelled:
+                self.dropped(connection)
+            case .waiting:
+                /* Sin ruta al terminal: se falla ya en vez de esperar a que vuelva la red */
+                connection.cancel()
+            default:
+                break
+            }
+        }
+        receive(on: connection)
+        connection.start(queue: queue)
+        return connection
+    }
+
+    private func receive(on connection: NWConnection) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 64 * 1024) { [weak self] data, _, isComplete, error in
+            guard let self = self, connection === self.connection else {
+                return
+            }
+            if let data = data, !data.isEmpty {
+                self.onReceive?(data)
+            }
+            if isComplete || error != nil {
+                connection.cancel()
+            } else {
+                self.receive(on: connection)
+            }
+        }
+    }
+
+    private func dropped(_ connection: NWConnection) {
+        detach(connection)
+        onDisconnect?()
+    }
+
+    private func detach(_ connection: NWConnection) {
+        connection.stateUpdateHandler = nil
+        connection.cancel()
+        self.connection = nil
+        isReady = false
+        pending.removeAll()
+    }
+}
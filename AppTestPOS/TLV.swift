@@ -0,0 +1,257 @@
+//
+//  TLV.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// A BER-TLV tag, stored as its encoded bytes (e.g. 0x9F02).
+struct TLVTag: RawRepresentable, Hashable {
+    let rawValue: UInt32
+
+    init(rawValue: UInt32) {
+        self.rawValue = rawValue
+    }
+
+    init(_ rawValue: UInt32) {
+        self.rawValue = rawValue
+    }
+
+    /// Constructed tags (bit 6 of the first byte) hold nested TLV elements.
+    var isConstructed: Bool {
+        var first = rawValue
+        while first > 0xFF {
+            first >>= 8
+        }
+        return first & 0x20 != 0
+    }
+}
+
+/* Etiquetas EMV usadas en doTransactionEx:withData: y en extendedData de la respuesta */
+extension TLVTag {
+    static let applicationIdentifier = TLVTag(0x4F)
+    static let applicationLabel = TLVTag(0x50)
+    static let track2Equivalent = TLVTag(0x57)
+    static let maskedPan = TLVTag(0x5A)
+    static let cardholderName = TLVTag(0x5F20)
+    static let transactionCurrencyCode = TLVTag(0x5F2A)
+    static let panSequenceNumber = TLVTag(0x5F34)
+    static let responseTemplate = TLVTag(0x77)
+    static let authorisationResponseCode = TLVTag(0x8A)
+    static let dedicatedFileName = TLVTag(0x84)
+    static let terminalVerificationResults = TLVTag(0x95)
+    static let transactionDate = TLVTag(0x9A)
+    static let transactionStatusInformation = TLVTag(0x9B)
+    static let transactionType = TLVTag(0x9C)
+    static let amountAuthorised = TLVTag(0x9F02)
+    static let amountOther = TLVTag(0x9F03)
+    static let applicationVersionNumber = TLVTag(0x9F09)
+    static let issuerApplicationData = TLVTag(0x9F10)
+    static let terminalCountryCode = TLVTag(0x9F1A)
+    static let transactionTime = TLVTag(0x9F21)
+    static let applicationCryptogram = TLVTag(0x9F26)
+    static let cryptogramInformationData = TLVTag(0x9F27)
+    static let cvmResults = TLVTag(0x9F34)
+    static let applicationTransactionCounter = TLVTag(0x9F36)
+    static let unpredictableNumber = TLVTag(0x9F37)
+    static let posEntryMode = TLVTag(0x9F39)
+}
+
+/// One element of a TLV stream; `value` is a slice of the original buffer, not a copy.
+struct TLVElement {
+    let tag: TLVTag
+    let value: Data
+
+    /// Nested elements of a constructed tag, decoded lazily.
+    var children: TLVReader {
+        return TLVReader(value)
+    }
+}
+
+/// Lazy BER-TLV reader.
+///
+/// Elements are decoded one at a time while iterating, so looking up a couple of tags in a
+/// large extended reply does not decode the rest of it. Iteration stops at the first malformed
+/// element; `isWellFormed` walks the whole buffer when that needs to be known up front.
+struct TLVReader: Sequence {
+
+    let data: Data
+
+    init(_ data: Data) {
+        self.data = data
+    }
+
+    struct Iterator: IteratorProtocol {
+        private let data: Data
+        private var position: Int
+        private(set) var failed = false
+
+        fileprivate init(_ data: Data) {
+            self.data = data
+            self.position = data.startIndex
+        }
+
+        var isAtEnd: Bool {
+            return position >= data.endIndex
+        }
+
+        mutating func next() -> TLVElement? {
+            let end = data.endIndex
+            /* 0x00 y 0xFF son relleno permitido entre elementos */
+            while position < end && (data[position] == 0x00 || data[position] == 0xFF) {
+                position += 1
+            }
+            guard position < end, !failed else {
+                return nil
+            }
+
+            var tag = UInt32(data[position])
+            position += 1
+            if tag & 0x1F == 0x1F {
+                repeat {
+                    guard position < end, tag <= 0x00FF_FFFF else {
+                        return fail()
+                    }
+                    tag = tag << 8 | UInt32(data[position])
+                    position += 1
+                } while tag & 0x80 != 0
+            }
+
+            guard position < end else {
+                return fail()
+            }
+            var length = Int(data[position])
+            position += 1
+            if length & 0x80 != 0 {
+                let count = length & 0x7F
+                guard count >= 1, count <= 3, end - position >= count else {
+                    return fail()
+                }
+                length = 0
+                for _ in 0..<count {
+                    length = length << 8 | Int(data[position])
+                    position += 1
+                }
+            }
+            guard end - position >= length else {
+                return fail()
+            }
+
+            let value = data[position..<(position + length)]
+            position += length
+            return TLVElement(tag: TLVTag(tag), value: value)
+        }
+
+        private mutating func fail() -> TLVElement? {
+            failed = true
+            position = data.endIndex
+            return nil
+        }
+    }
+
+    func makeIterator() -> Iterator {
+        return Iterator(data)
+    }
+
+    /// First element with `tag`, looking into constructed elements when `recursive` is set.
+    func element(_ tag: TLVTag, recursive: Bool = true) -> TLVElement? {
+        for element in self {
+            if element.tag == tag {
+                return element
+            }
+            if recursive && element.tag.isConstructed, let nested = element.children.element(tag, recursive: true) {
+                return nested
+            }
+        }
+        return nil
+    }
+
+    subscript(tag: TLVTag) -> Data? {
+        return element(tag)?.value
+    }
+
+    var isWellFormed: Bool {
+        var iterator = makeIterator()
+        while iterator.next() != nil {
+        }
+        return !iterator.failed
+    }
+
+    /// Reads TLV data held in a C field (e.g. `zoneRep`) without copying it; the reader must not
+    /// outlive the closure.
+    static func withReader<R>(over bytes: UnsafeRawBufferPointer, _ body: (TLVReader) throws -> R) rethrows -> R {
+        guard let base = bytes.baseAddress, bytes.count > 0 else {
+            return try body(TLVReader(Data()))
+        }
+        let data = Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: base), count: bytes.count, deallocator: .none)
+        return try body(TLVReader(data))
+    }
+}
+
+/// BER-TLV writer for the `extendedData` passed to `doTransactionEx:withData:andApplicationNumber:`.
+struct TLVWriter {
+
+    private(set) var data = Data()
+
+    init(capacity: Int = 256) {
+        data.reserveCapacity(capacity)
+    }
+
+    mutating func append(_ tag: TLVTag, _ value: Data) {
+        appendTag(tag)
+        appendLength(value.count)
+        data.append(value)
+    }
+
+    mutating func append(_ tag: TLVTag, _ value: String) {
+        append(tag, Data(value.utf8))
+    }
+
+    /// Numeric value as packed BCD over `length` bytes, e.g. amounts for 9F02.
+    mutating func append(_ tag: TLVTag, bcd value: UInt64, length: Int) {
+        var bytes = [UInt8](repeating: 0, count: length)
+        var remaining = value
+        for index in stride(from: length - 1, through: 0, by: -1) {
+            let low = UInt8(remaining % 10)
+            remaining /= 10
+            let high = UInt8(remaining % 10)
+            remaining /= 10
+            bytes[index] = high << 4 | low
+        }
+        append(tag, Data(bytes))
+    }
+
+    /// Appends a constructed element whose content is written by `body`.
+    mutating func appendConstructed(_ tag: TLVTag, _ body: (inout TLVWriter) -> Void) {
+        var nested = TLVWriter(capacity: 64)
+        body(&nested)
+        append(tag, nested.data)
+    }
+
+    private mutating func appendTag(_ tag: TLVTag) {
+        var started = false
+        for shift in stride(from: 24, through: 0, by: -8) {
+            let byte = UInt8(truncatingIfNeeded: tag.rawValue >> UInt32(shift))
+            if started || byte != 0 || shift == 0 {
+                data.append(byte)
+                started = true
+            }
+        }
+    }
+
+    private mutating func appendLength(_ length: Int) {
+        switch length {
+        case 0..<0x80:
+            data.append(UInt8(length))
+        case 0x80...0xFF:
+            data.append(contentsOf: [0x81, UInt8(length)])
+        case 0x100...0xFFFF:
+            data.append(contentsOf: [0x82, UInt8(length >> 8), UInt8(length & 0xFF)])
+        default:
+            data.append(contentsOf: [0x83, UInt8((length >> 16) & 0xFF), UInt8((length >> 8) & 0xFF), UInt8(length & 0xFF)])
+        }
+    }
+}
@@ -0,0 +1,614 @@
+//
+//  TerminalSession.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import os
+import iSMP
+import mPosIntegradoFrameworkiOS
+
+/// Byte transport to one terminal.
+protocol PosLink: AnyObject {
+    /// Raw bytes received from the terminal; may be called on any thread.
+    var onReceive: ((Data) -> Void)? { get set }
+    var onDisconnect: (() -> Void)? { get set }
+    /// `true` when the link carries the raw byte stream and the host must ACK/NAK frames itself.
+    var acknowledgesFrames: Bool { get }
+    func send(_ bytes: Data)
+}
+
+/// A link that buffers incoming bytes in a `ByteRing` instead of handing each chunk to
+/// `onReceive`, so the session can parse them in batches on its own queue.
+protocol BufferedPosLink: PosLink {
+    var ring: ByteRing { get }
+    /// Runs `readable` on `queue` whenever bytes are waiting in `ring`; wake-ups that arrive
+    /// before it runs are coalesced into one call.
+    func deliver(on queue: DispatchQueue, readable: @escaping () -> Void)
+}
+
+enum PosError: Error {
+    case disconnected
+    case corruptedFrame
+    case rejected
+    case timeout
+    /// The command stayed longer than its budget in one phase (see `CommandPhase`).
+    case phaseTimeout(CommandPhase)
+    case cancelled
+    /// The terminal answered with a different message than the command expects.
+    case unexpectedResponse
+}
+
+/// Cancels the commands it was passed to; cancelling twice or after completion does nothing.
+final class CancellationToken {
+
+    /// A handler added with `onCancel`; remove it once the work it would cancel has ended, so a
+    /// long-lived token does not accumulate the handlers of every command it was passed to.
+    struct Registration {
+        fileprivate weak var token: CancellationToken?
+        fileprivate let key: UInt64
+
+        func remove() {
+            token?.remove(key)
+        }
+    }
+
+    private let lock = NSLock()
+    private var cancelled = false
+    private var handlers: [UInt64: () -> Void] = [:]
+    private var nextKey: UInt64 = 0
+
+    var isCancelled: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return cancelled
+    }
+
+    /// Handlers still registered; for checking that finished work removed its own.
+    var handlerCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return handlers.count
+    }
+
+    func cancel() {
+        lock.lock()
+        guard !cancelled else {
+            lock.unlock()
+            return
+        }
+        cancelled = true
+        let handlers = self.handlers.sorted { $0.key < $1.key }
+        self.handlers.removeAll()
+        lock.unlock()
+        handlers.forEach { $0.value() }
+    }
+
+    /// Runs `handler` on cancellation, immediately if the token is already cancelled.
+    @discardableResult
+    func onCancel(_ handler: @escaping () -> Void) -> Registration {
+        lock.lock()
+        nextKey += 1
+        let key = nextKey
+        guard !cancelled else {
+            lock.unlock()
+            handler()
+            return Registration(token: nil, key: key)
+        }
+        handlers[key] = handler
+        lock.unlock()
+        return Registration(token: self, key: key)
+    }
+
+    private func remove(_ key: UInt64) {
+        lock.lock()
+        handlers[key] = nil
+        lock.unlock()
+    }
+}
+
+/// Stages of a command on the terminal, each with its own time budget.
+enum CommandPhase: Int {
+    /// Until the terminal acknowledges or reports progress on the command.
+    case delivery
+    case cardRead
+    case pin
+    case authorization
+    case printing
+}
+
+struct PhaseTimeouts {
+    var delivery: TimeInterval = 5
+    var cardRead: TimeInterval = 60
+    var pin: TimeInterval = 45
+    var authorization: TimeInterval = 45
+    var printing: TimeInterval = 20
+
+    /// Budget from card read to the authorization answer, for a command that reports no
+    /// intermediate messages and so never moves past `.cardRead` on its own.
+    var throughAuthorization: TimeInterval {
+        return cardRead + pin + authorization
+    }
+
+    subscript(phase: CommandPhase) -> TimeInterval {
+        switch phase {
+        case .delivery: return delivery
+        case .cardRead: return cardRead
+        case .pin: return pin
+        case .authorization: return authorization
+        case .printing: return printing
+        }
+    }
+}
+
+/// One terminal: its link, its frame parser and a FIFO of commands, of which only one is in
+/// flight at a time. Everything runs on `queue`.
+final class TerminalSession {
+
+    typealias Completion = (Result<PosResponse, PosError>) -> Void
+
+    private struct Command {
+        let id: UInt64
+        let frame: Data
+        /// Holds every frame received for the command; released with the last response slice.
+        /// `nil` for streams, whose frames are dropped one by one as `onFrame` returns.
+        let arena: TransactionArena?
+        let expecting: String?
+        /// For multi-frame responses: called with each frame, returns `false` for the last one.
+        let onFrame: ((PosResponse) -> Bool)?
+        /// For multi-frame responses: whether a frame is the terminal's own end of the stream.
+        let isLast: ((PosResponse) -> Bool)?
+        let completion: Completion
+        let deadline: TimerWheel.Handle
+        let cancellation: CancellationToken.Registration?
+        var phase = CommandPhase.delivery
+        var phaseDeadline: TimerWheel.Handle?
+        var retransmissions = 0
+    }
+
+    /// Code of the intermediate messages the terminal sends while a command is in progress.
+    static let intermediateCode = "0900"
+    static let maximumRetransmissions = 3
+    /// Deadline applied when `send` is not given one; covers card entry and host authorization.
+    static let defaultTimeout: TimeInterval = 150
+    /// How long the rest of a stream stopped early is dropped after its last frame seen.
+    static let streamDrainWindow: TimeInterval = 5
+    /* Códigos de los mensajes intermedios 0900 que marcan el cambio de fase */
+    static let intermediatePhases: [Int: CommandPhase] = [
+        78: .cardRead,
+        79: .cardRead,
+        80: .cardRead,
+        81: .cardRead,
+        82: .cardRead,
+        83: .cardRead,
+        84: .cardRead,
+        85: .cardRead,
+        86: .pin,
+        87: .authorization,
+        88: .printing,
+    ]
+
+    let identifier: String
+    let terminal: ICTerminal?
+    let link: PosLink
+    let queue: DispatchQueue
+    let timers: TimerWheel
+    var phaseTimeouts = PhaseTimeouts()
+
+    /// Intermediate messages (0900) and frames received with no command in flight.
+    var onMessage: ((PosResponse) -> Void)?
+    /// Largest arena footprint of a single command so far, in bytes. Read it on `queue`.
+    private(set) var peakTransactionBytes = 0
+
+    private let parser = PosFrameParser()
+    private var pending: [Command] = []
+    private var current: Command?
+    private var nextId: UInt64 = 0
+    /// Code and end test of a stream stopped early, whose remaining frames are dropped.
+    private var discarding: (code: String, isLast: (PosResponse) -> Bool, until: DispatchTime)?
+
+    init(identifier: String, terminal: ICTerminal?, link: PosLink, queue: DispatchQueue, timers: TimerWheel = .shared) {
+        self.identifier = identifier
+        self.terminal = terminal
+        self.link = link
+        self.queue = queue
+        self.timers = timers
+
+        if let buffered = link as? BufferedPosLink {
+            let ring = buffered.ring
+            buffered.deliver(on: queue) { [weak self] in
+                ring.drain { self?.receive($0) }
+            }
+        } else {
+            link.onReceive = { [weak self] bytes in
+                guard let self = self else { return }
+                self.queue.async { self.receive(bytes) }
+            }
+        }
+        link.onDisconnect = { [weak self] in
+            guard let self = self else { return }
+            self.queue.async { self.failAll(.disconnected) }
+        }
+    }
+
+    /// Queues `command` (e.g. "0200|1000|123456|||0"); `completion` runs once on `queue` with the
+    /// final response, `.timeout` when `timeout` elapses first (time spent queued included) or
+    /// `.cancelled` when `token` is cancelled. With `expecting`, only a response with that code
+    /// completes the command and anything else goes to `onMessage`.
+    func send(_ command: String, expecting: String? = nil, timeout: TimeInterval = TerminalSession.defaultTimeout,
+              token: CancellationToken? = nil, completion: @escaping Completion) {
+        enqueue(command, expecting: expecting, onFrame: nil, isLast: nil, timeout: timeout, token: token, completion: completion)
+    }
+
+    /// Like `send`, for commands answered with several `expecting` frames (e.g. 0260 details).
+    /// Each frame goes to `onFrame` as it arrives and is not kept: streams get no arena, so the
+    /// parser reuses its buffer once `onFrame` lets go of the frame. Returning `false` ends the
+    /// command with that frame, which lets the caller stop early. The frames the terminal keeps
+    /// sending after that are dropped up to the one `isLast` accepts, so none of them is taken
+    /// as the answer to a later command.
+    func stream(_ command: String, expecting: String, timeout: TimeInterval = TerminalSession.defaultTimeout,
+                token: CancellationToken? = nil, isLast: @escaping (PosResponse) -> Bool,
+                onFrame: @escaping (PosResponse) -> Bool, completion: @escaping Completion) {
+        enqueue(command, expecting: expecting, onFrame: onFrame, isLast: isLast, timeout: timeout, token: token, completion: completion)
+    }
+
+    private func enqueue(_ command: String, expecting: String?, onFrame: ((PosResponse) -> Bool)?,
+                         isLast: ((PosResponse) -> Bool)?, timeout: TimeInterval, token: CancellationToken?,
+                         completion: @escaping Completion) {
+        let frame = PosFrame.encode(command)
+        queue.async {
+            self.nextId += 1
+            let id = self.nextId
+            let deadline = self.timers.schedule(after: timeout) { [weak self] in
+                guard let self = self else { return }
+                self.queue.async { self.abandon(id, .timeout) }
+            }
+            let cancellation = token?.onCancel { [weak self] in
+                guard let self = self else { return }
+                self.queue.async { self.abandon(id, .cancelled) }
+            }
+            self.pending.append(Command(id: id, frame: frame, arena: onFrame == nil ? TransactionArena() : nil,
+                                        expecting: expecting, onFrame: onFrame, isLast: isLast,
+                                        completion: completion, deadline: deadline, cancellation: cancellation))
+            self.startNext()
+        }
+    }
+
+    /// Moves the command in flight to `phase` and restarts its phase budget, e.g. from the
+    /// printing callbacks of `ICPclServiceDelegate`. Phases never go backwards.
+    func advance(to phase: CommandPhase) {
+        queue.async {
+            self.enter(phase)
+        }
+    }
+
+    func cancelAll() {
+        queue.async {
+            self.failAll(.cancelled)
+        }
+    }
+
+    private func startNext() {
+        guard current == nil, !pending.isEmpty else {
+            return
+        }
+        let command = pending.removeFirst()
+        current = command
+        parser.arena = command.arena
+        link.send(command.frame)
+        if link.acknowledgesFrames {
+            enter(.delivery, force: true)
+        } else {
+            /* El SDK no entrega ACK ni 0900: sin cambios de fase solo rige el plazo total del comando */
+            current?.phase = .cardRead
+        }
+    }
+
+    /// Starts `phase` with its budget, or with `budget` when given.
+    private func enter(_ phase: CommandPhase, force: Bool = false, budget: TimeInterval? = nil) {
+        guard var command = current, force || phase.rawValue > command.phase.rawValue else {
+            return
+        }
+        if let previous = command.phaseDeadline {
+            timers.cancel(previous)
+        }
+        let id = command.id
+        command.phase = phase
+        command.phaseDeadline = timers.schedule(after: budget ?? phaseTimeouts[phase]) { [weak self] in
+            guard let self = self else { return }
+            self.queue.async { self.abandon(id, .phaseTimeout(phase), phase: phase) }
+        }
+        current = command
+    }
+
+    private func receive<C: Collection>(_ bytes: C) where C.Element == UInt8 {
+        for event in parser.feed(bytes) {
+            switch event {
+            case .ack:
+                /* Hasta el primer 0900 no se sabe si el terminal informará las fases: se da el plazo hasta la autorización */
+                enter(.cardRead, budget: phaseTimeouts.throughAuthorization)
+            case .nak:
+                retransmit()
+            case .corrupted:
+                if link.acknowledgesFrames {
+                    link.send(Data([PosFrame.NAK]))
+                } else {
+                    finish(.failure(.corruptedFrame))
+                }
+            case .frame(let response):
+                if link.acknowledgesFrames {
+                    link.send(Data([PosFrame.ACK]))
+                }
+                if let leftover = discarding, leftover.code == response.code, DispatchTime.now() < leftover.until {
+                    /* Resto de un stream cortado antes de tiempo: no es respuesta de ningún comando */
+                    discarding = leftover.isLast(response) ? nil
+                        : (leftover.code, leftover.isLast, .now() + TerminalSession.streamDrainWindow)
+                    continue
+                }
+                if current != nil && response.code == TerminalSession.intermediateCode {
+                    /* Un 0900 de la misma fase también renueva su plazo */
+                    let phase = response.integer(1).flatMap { TerminalSession.intermediatePhases[$0] } ?? .cardRead
+                    enter(phase, force: phase == current?.phase)
+                    onMessage?(response)
+                } else if current == nil || (current?.expecting.map { $0 != response.code } ?? false) {
+                    onMessage?(response)
+                } else if let command = current, let onFrame = command.onFrame, onFrame(response) {
+                    /* Cada frame del stream renueva el plazo de la fase actual */
+                    enter(command.phase, force: true)
+                } else {
+                    if let isLast = current?.isLast, !isLast(response) {
+                        discarding = (response.code, isLast, .now() + TerminalSession.streamDrainWindow)
+                    }
+                    finish(.success(response))
+                }
+            }
+        }
+    }
+
+    private func retransmit() {
+        guard var command = current else {
+            return
+        }
+        guard command.retransmissions < TerminalSession.maximumRetransmissions else {
+            finish(.failure(.rejected))
+            return
+        }
+        command.retransmissions += 1
+        current = command
+        link.send(command.frame)
+    }
+
+    private func finish(_ result: Result<PosResponse, PosError>) {
+        guard let command = current else {
+            return
+        }
+        current = nil
+        parser.arena = nil
+        peakTransactionBytes = max(peakTransactionBytes, command.arena?.reservedBytes ?? 0)
+        release(command)
+        command.completion(result)
+        startNext()
+    }
+
+    /// Cancels the command's timers and removes its cancellation handler.
+    private func release(_ command: Command) {
+        command.cancellation?.remove()
+        timers.cancel(command.deadline)
+        if let phaseDeadline = command.phaseDeadline {
+            timers.cancel(phaseDeadline)
+        }
+    }
+
+    /// Completes command `id` with `error` wherever it is; the terminal is not told, so a late
+    /// answer to an abandoned in-flight command arrives through `onMessage`.
+    private func abandon(_ id: UInt64, _ error: PosError, phase: CommandPhase? = nil) {
+        if let command = current, command.id == id {
+            /* Un timer de fase ya reemplazado no debe terminar el comando */
+            if let phase = phase, phase != command.phase {
+                return
+            }
+            finish(.failure(error))
+        } else if let index = pending.firstIndex(where: { $0.id == id }) {
+            let command = pending.remove(at: index)
+            release(command)
+            command.completion(.failure(error))
+        }
+    }
+
+    private func failAll(_ error: PosError) {
+        parser.reset()
+        discarding = nil
+        let commands = (current.map { [$0] } ?? []) + pending
+        current = nil
+        parser.arena = nil
+        pending.removeAll()
+        for command in commands {
+            release(command)
+            command.completion(.failure(error))
+        }
+    }
+}
+
+/// Owns the sessions of every terminal driven by this process.
+///
+/// Each session runs on its own strand of `executor`: links hand their bytes to it and parsing,
+/// queueing and completion happen there, in order for that terminal and in parallel with others.
+final class TerminalSessionHost {
+
+    let executor: CallbackExecutor
+
+    private let lock = NSLock()
+    private var registry: [String: TerminalSession] = [:]
+
+    init(executor: CallbackExecutor = .shared) {
+        self.executor = executor
+    }
+
+    /// Opens a session for `identifier`, replacing (and cancelling) any previous one.
+    @discardableResult
+    func open(identifier: String, terminal: ICTerminal? = nil, link: PosLink) -> TerminalSession {
+        let queue = executor.strand("session.\(identifier)")
+        let session = TerminalSession(identifier: identifier, terminal: terminal, link: link, queue: queue)
+        lock.lock()
+        let previous = registry.updateValue(session, forKey: identifier)
+        lock.unlock()
+        previous?.cancelAll()
+        return session
+    }
+
+    /// Cancels the session's commands and forgets its strand; the session keeps its queue until
+    /// those cancellations have run.
+    func close(_ identifier: String) {
+        lock.lock()
+        let session = registry.removeValue(forKey: identifier)
+        lock.unlock()
+        session?.cancelAll()
+        executor.removeStrand("session.\(identifier)")
+    }
+
+    func session(_ identifier: String) -> TerminalSession? {
+        lock.lock()
+        defer { lock.unlock() }
+        return registry[identifier]
+    }
+
+    var sessions: [TerminalSession] {
+        lock.lock()
+        defer { lock.unlock() }
+        return registry.keys.sorted().compactMap { registry[$0] }
+    }
+}
+
+/*Enlace a través de mPosIntegrado: el SDK maneja ACK/NAK y entrega la respuesta en hexadecimal*/
+final class MposIntegradoLink: PosLink {
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+    let acknowledgesFrames = false
+
+    private let utils: mPosIntegrado
+
+    init(utils: mPosIntegrado) {
+        self.utils = utils
+        utils.onFinishTransaction = { [weak self] result in
+            self?.receive(hex: result)
+        }//NEEDED TO CAPTURE RESULT OF TRANSACTION
+    }
+
+    func send(_ bytes: Data) {
+        let hexCommand = PosFrame.hexEncoded(bytes)
+        DispatchQueue.main.async {
+            _ = self.utils.startTransaction(payload: hexCommand)
+        }
+    }
+
+    private func receive(hex: String) {
+        print("Hex response: \(hex)")
+        guard let bytes = PosFrame.hexDecoded(hex) else {
+            /* Un frame con LRC inválido hace fallar el comando en curso */
+            onReceive?(Data([PosFrame.STX, PosFrame.ETX, 0]))
+            return
+        }
+        /* Si la respuesta llega sin STX/ETX se arma el frame para el parser */
+        onReceive?(bytes.contains(PosFrame.STX) ? bytes : PosFrame.encode(payload: bytes))
+    }
+}
+
+/*Enlace SPP (Bluetooth) directo al terminal: bytes crudos, el host hace ACK/NAK de cada frame*/
+final class SPPLink: NSObject, BufferedPosLink, ICISMPDeviceDelegate, ICISMPDeviceExtensionDelegate {
+
+    var onReceive: ((Data) -> Void)?
+    var onDisconnect: (() -> Void)?
+    let acknowledgesFrames = true
+    let ring: ByteRing
+
+    private let channel: ICSPP
+    /// Guards `readable` and `waitingForSpace`, shared by the stream thread and the session queue.
+    private let lock: os_unfair_lock_t = {
+        let lock = os_unfair_lock_t.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+    private var readable: DispatchSourceUserDataOr?
+    private var waitingForSpace = false
+    /// Signalled by the session after a drain while the stream thread waits on a full ring.
+    private let space = DispatchSemaphore(value: 0)
+
+    init(channel: ICSPP = ICSPP.sharedChannel(), ringCapacity: Int = 64 * 1024) {
+        self.channel = channel
+        self.ring = ByteRing(capacity: ringCapacity)
+        super.init()
+        channel.delegate = self
+    }
+
+    deinit {
+        readable?.cancel()
+        lock.deinitialize(count: 1)
+        lock.deallocate()
+    }
+
+    func deliver(on queue: DispatchQueue, readable handler: @escaping () -> Void) {
+        let source = DispatchSource.makeUserDataOrSource(queue: queue)
+        source.setEventHandler { [weak self] in
+            handler()
+            self?.drained()
+        }
+        source.resume()
+        os_unfair_lock_lock(lock)
+        let previous = readable
+        readable = source
+        os_unfair_lock_unlock(lock)
+        previous?.cancel()
+        if ring.count > 0 {
+            source.or(data: 1)
+        }
+    }
+
+    func send(_ bytes: Data) {
+        if !channel.SendDataAsync(bytes) {
+            onDisconnect?()
+        }
+    }
+
+    /* Cola de la sesión: tras vaciar el ring se despierta al hilo del stream si estaba esperando */
+    private func drained() {
+        os_unfair_lock_lock(lock)
+        let waiting = waitingForSpace
+        waitingForSpace = false
+        os_unfair_lock_unlock(lock)
+        if waiting {
+            space.signal()
+        }
+    }
+
+    /* Hilo del stream: se copia al ring y se despierta al consumidor; con el ring lleno se espera su aviso */
+    @objc(didReceiveData:fromICISMPDevice:)
+    func didReceive(_ data: Data!, fromICISMPDevice sender: ICISMPDevice!) {
+        guard let data = data else { return }
+        data.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) in
+            var offset = 0
+            while offset < bytes.count {
+                let written = ring.write(UnsafeRawBufferPointer(rebasing: bytes[offset...]))
+                offset += written
+                os_unfair_lock_lock(lock)
+                if written == 0 {
+                    waitingForSpace = true
+                }
+                let source = readable
+                os_unfair_lock_unlock(lock)
+                source?.or(data: 1)
+                if written == 0 {
+                    /* El aviso llega tras el próximo drenaje; el plazo cubre una sesión aún sin enganchar */
+                    _ = space.wait(timeout: .now() + .seconds(1))
+                }
+            }
+        }
+    }
+
+    func accessoryDidDisconnect(_ sender: ICISMPDevice!) {
+        onDisconnect?()
+    }
+}
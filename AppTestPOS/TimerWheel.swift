@@ -0,0 +1,210 @@
+//
+//  TimerWheel.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import os
+
+/// Hierarchical timer wheel for command deadlines.
+///
+/// Four levels of 64 slots; a timer goes into the level whose span covers its delay and moves
+/// down a level each time that level's slot comes round, so scheduling, cancelling and firing
+/// are O(1) per timer however many sessions are waiting. One `DispatchSourceTimer` drives the
+/// wheel and only runs while there are timers.
+final class TimerWheel {
+
+    /// A scheduled timer; keep it to cancel it. Timers live in intrusive doubly linked slot lists.
+    final class Handle {
+        fileprivate var expiry: UInt64 = 0
+        fileprivate var slot = -1
+        fileprivate var previous: Handle?
+        fileprivate var next: Handle?
+        fileprivate var handler: (() -> Void)?
+    }
+
+    static let shared = TimerWheel()
+
+    private static let slotBits = 6
+    private static let slotCount = 1 << slotBits
+    private static let slotMask = UInt64(slotCount - 1)
+    private static let levels = 4
+    private static let maximumTicks = UInt64(1) << UInt64(slotBits * levels) - 1
+
+    /// Resolution of the wheel; deadlines are rounded up to a whole tick.
+    let tick: TimeInterval
+    let queue: DispatchQueue
+
+    private let lock: os_unfair_lock_t = {
+        let lock = os_unfair_lock_t.allocate(capacity: 1)
+        lock.initialize(to: os_unfair_lock())
+        return lock
+    }()
+    private var slots = [Handle?](repeating: nil, count: TimerWheel.levels * TimerWheel.slotCount)
+    private var now: UInt64 = 0
+    private var origin = DispatchTime.now()
+    private var count = 0
+    private var source: DispatchSourceTimer?
+
+    init(tick: TimeInterval = 0.01, queue: DispatchQueue = DispatchQueue(label: "cl.transbank.timer-wheel")) {
+        self.tick = tick
+        self.queue = queue
+    }
+
+    deinit {
+        source?.cancel()
+        lock.deinitialize(count: 1)
+        lock.deallocate()
+    }
+
+    var scheduledCount: Int {
+        os_unfair_lock_lock(lock)
+        defer { os_unfair_lock_unlock(lock) }
+        return count
+    }
+
+    /// Runs `handler` on `queue` after `delay` seconds, unless cancelled first.
+    @discardableResult
+    func schedule(after delay: TimeInterval, _ handler: @escaping () -> Void) -> Handle {
+        let handle = Handle()
+        handle.handler = handler
+        let ticks = min(UInt64(max(1, (delay / tick).rounded(.up))), TimerWheel.maximumTicks)
+
+        os_unfair_lock_lock(lock)
+        if count == 0 {
+            /* Sin timers pendientes el reloj lógico se resincroniza en vez de recorrer los ticks perdidos */
+            now = currentTick()
+        }
+        handle.expiry = now + ticks
+        insert(handle)
+        count += 1
+        let start = source == nil
+        os_unfair_lock_unlock(lock)
+
+        if start {
+            queue.async { self.startSource() }
+        }
+        return handle
+    }
+
+    /// Cancels `handle`; returns `false` if it already fired or was cancelled.
+    @discardableResult
+    func cancel(_ handle: Handle) -> Bool {
+        os_unfair_lock_lock(lock)
+        defer { os_unfair_lock_unlock(lock) }
+        guard handle.slot >= 0 else {
+            return false
+        }
+        unlink(handle)
+        handle.handler = nil
+        count -= 1
+        return true
+    }
+
+    private func currentTick() -> UInt64 {
+        let elapsed = DispatchTime.now().uptimeNanoseconds &- origin.uptimeNanoseconds
+        return UInt64(Double(elapsed) / (tick * 1_000_000_000))
+    }
+
+    private func insert(_ handle: Handle) {
+        let delta = handle.expiry > now ? handle.expiry - now : 0
+        var level = 0
+        while level < TimerWheel.levels - 1 && delta >> UInt64(TimerWheel.slotBits * (level + 1)) != 0 {
+            level += 1
+        }
+        let index = Int((handle.expiry >> UInt64(TimerWheel.slotBits * level)) & TimerWheel.slotMask)
+        let slot = level * TimerWheel.slotCount + index
+        handle.slot = slot
+        handle.previous = nil
+        handle.next = slots[slot]
+        slots[slot]?.previous = handle
+        slots[slot] = handle
+    }
+
+    private func unlink(_ handle: Handle) {
+        if let previous = handle.previous {
+            previous.next = handle.next
+        } else {
+            slots[handle.slot] = handle.next
+        }
+        handle.next?.previous = handle.previous
+        handle.previous = nil
+        handle.next = nil
+        handle.slot = -1
+    }
+
+    private func takeSlot(_ slot: Int) -> [Handle] {
+        var handles: [Handle] = []
+        var handle = slots[slot]
+        while let current = handle {
+            handle = current.next
+            current.previous = nil
+            current.next = nil
+            current.slot = -1
+            handles.append(current)
+        }
+        slots[slot] = nil
+        return handles
+    }
+
+    /// Advances one tick: cascades the higher levels whose slot just came round, then returns the
+    /// handlers of the level 0 slot.
+    private func advance(into expired: inout [() -> Void]) {
+        now += 1
+        var level = 1
+        while level < TimerWheel.levels && now & ((UInt64(1) << UInt64(TimerWheel.slotBits * level)) - 1) == 0 {
+            level += 1
+        }
+        for cascading in stride(from: level - 1, through: 1, by: -1) {
+            let index = Int((now >> UInt64(TimerWheel.slotBits * cascading)) & TimerWheel.slotMask)
+            for handle in takeSlot(cascading * TimerWheel.slotCount + index) {
+                insert(handle)
+            }
+        }
+        for handle in takeSlot(Int(now & TimerWheel.slotMask)) {
+            if let handler = handle.handler {
+                expired.append(handler)
+            }
+            handle.handler = nil
+            count -= 1
+        }
+    }
+
+    private func startSource() {
+        guard source == nil else {
+            return
+        }
+        let source = DispatchSource.makeTimerSource(queue: queue)
+        let nanoseconds = Int(tick * 1_000_000_000)
+        let interval = DispatchTimeInterval.nanoseconds(nanoseconds)
+        source.schedule(deadline: .now() + interval, repeating: interval, leeway: .nanoseconds(nanoseconds / 2))
+        source.setEventHandler { [weak self] in
+            self?.fire()
+        }
+        os_unfair_lock_lock(lock)
+        self.source = source
+        os_unfair_lock_unlock(lock)
+        source.resume()
+    }
+
+    private func fire() {
+        var expired: [() -> Void] = []
+        os_unfair_lock_lock(lock)
+        let target = currentTick()
+        while now < target && count > 0 {
+            advance(into: &expired)
+        }
+        var idle: DispatchSourceTimer?
+        if count == 0 {
+            idle = source
+            source = nil
+        }
+        os_unfair_lock_unlock(lock)
+
+        idle?.cancel()
+        expired.forEach { $0() }
+    }
+}
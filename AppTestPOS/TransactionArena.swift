@@ -0,0 +1,65 @@
+//
+//  TransactionArena.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+
+/// Monotonic arena for the decoded state of one transaction.
+///
+/// Bytes are only ever appended, into `chunkSize` blocks taken from a `FrameBufferPool`, and
+/// nothing is freed individually: the blocks go back to the pool together once the arena and
+/// every slice handed out from it are gone. A sale thus costs a pool round trip per chunk
+/// (usually one) instead of an allocation per frame, field and callback, and its footprint
+/// is `reservedBytes`. Not thread-safe; an arena belongs to its session's queue.
+final class TransactionArena {
+
+    static let defaultChunkSize = 4096
+
+    let pool: FrameBufferPool
+    let chunkSize: Int
+
+    /// Chunk that `store` appends to.
+    private var current: FrameBuffer?
+    /// Every chunk reserved so far, including those handed to in-place writers.
+    private var chunks: [FrameBuffer] = []
+
+    init(pool: FrameBufferPool = .shared, chunkSize: Int = TransactionArena.defaultChunkSize) {
+        self.pool = pool
+        self.chunkSize = chunkSize
+    }
+
+    var reservedBytes: Int {
+        return chunks.reduce(0) { $0 + $1.capacity }
+    }
+
+    var usedBytes: Int {
+        return chunks.reduce(0) { $0 + $1.count }
+    }
+
+    /// Copies `bytes` into the arena.
+    func store<C: Collection>(_ bytes: C) -> FrameSlice where C.Element == UInt8 {
+        if current.map({ $0.capacity - $0.count < bytes.count }) ?? true {
+            current = reserve(minimumCapacity: bytes.count)
+        }
+        let chunk = current!
+        let start = chunk.count
+        chunk.append(contentsOf: bytes)
+        return chunk.slice(start..<chunk.count)
+    }
+
+    func store(_ text: String) -> FrameSlice {
+        return store(text.utf8)
+    }
+
+    /// A chunk of its own for a writer that fills it in place, such as the frame parser; `store`
+    /// never appends to it.
+    func reserve(minimumCapacity: Int) -> FrameBuffer {
+        let chunk = pool.buffer(minimumCapacity: max(minimumCapacity, chunkSize))
+        chunks.append(chunk)
+        return chunk
+    }
+}
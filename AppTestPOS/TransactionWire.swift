@@ -0,0 +1,200 @@
+//
+//  TransactionWire.swift
+//  SampleApp
+//
+//  Created by Developer on 18-10-26.
+//  Copyright © 2026 Ingenico. All rights reserved.
+//
+
+import Foundation
+import iSMP
+
+/// Conversion of the zero padded ASCII numbers used by the standalone transaction structs.
+///
+/// The eight amount characters are handled as one little-endian 64-bit word (SWAR), so parsing
+/// and formatting take a handful of multiplications and no per-character loop.
+enum AsciiDigits {
+
+    /// Parses eight ASCII digits, first digit in the lowest byte; `nil` if any byte is not a digit.
+    static func parse8(_ word: UInt64) -> UInt32? {
+        let highNibbles = word & 0xF0F0_F0F0_F0F0_F0F0
+        let carried = (word &+ 0x0606_0606_0606_0606) & 0xF0F0_F0F0_F0F0_F0F0
+        guard highNibbles == 0x3030_3030_3030_3030, carried == 0x3030_3030_3030_3030 else {
+            return nil
+        }
+        var value = word & 0x0F0F_0F0F_0F0F_0F0F
+        value = (value &* (10 << 8 + 1)) >> 8
+        value = ((value & 0x00FF_00FF_00FF_00FF) &* (100 << 16 + 1)) >> 16
+        value = ((value & 0x0000_FFFF_0000_FFFF) &* (10000 << 32 + 1)) >> 32
+        return UInt32(truncatingIfNeeded: value)
+    }
+
+    /// Formats `value` (below 100 000 000) as eight ASCII digits, first digit in the lowest byte.
+    static func format8(_ value: UInt32) -> UInt64 {
+        let x = UInt64(value / 10000) | UInt64(value % 10000) << 32
+        let hundreds = ((x &* 5243) >> 19) & 0x0000_007F_0000_007F
+        let pairs = hundreds | (x &- hundreds &* 100) << 16
+        let tens = ((pairs &* 103) >> 10) & 0x000F_000F_000F_000F
+        let digits = tens | (pairs &- tens &* 10) << 8
+        return digits | 0x3030_3030_3030_3030
+    }
+
+    /// Loads eight bytes as a little-endian word without requiring any alignment.
+    static func word(_ bytes: UnsafeRawBufferPointer) -> UInt64 {
+        var word: UInt64 = 0
+        withUnsafeMutableBytes(of: &word) { $0.copyMemory(from: UnsafeRawBufferPointer(rebasing: bytes.prefix(8))) }
+        return UInt64(littleEndian: word)
+    }
+
+    /// Parses up to eight ASCII digits; shorter fields are left padded with '0' before the SWAR parse.
+    static func parse<C: Collection>(_ bytes: C) -> UInt32? where C.Element == UInt8 {
+        guard !bytes.isEmpty, bytes.count <= 8 else {
+            return nil
+        }
+        var word: UInt64 = 0x3030_3030_3030_3030
+        var shift = UInt64(8 - bytes.count) * 8
+        for byte in bytes {
+            word = word & ~(0xFF << shift) | UInt64(byte) << shift
+            shift += 8
+        }
+        return parse8(word)
+    }
+}
+
+/// Field access over `ICTransactionReply` without going through `ICTransactionReplyObject`.
+///
+/// Amount and currency are read straight from the C arrays; text is only materialized for the
+/// authorization number, which is what callers keep.
+struct TransactionReplyView {
+
+    let reply: ICTransactionReply
+
+    init(_ reply: ICTransactionReply) {
+        self.reply = reply
+    }
+
+    var posNumber: Int {
+        return Int(reply.posNumber)
+    }
+
+    var operationStatus: UInt8 {
+        return reply.operationStatus
+    }
+
+    var accountType: UInt8 {
+        return reply.accountType
+    }
+
+    /// The transaction amount, or `nil` if the field is not eight ASCII digits.
+    var amount: Int? {
+        let word = withUnsafeBytes(of: reply.amount) { AsciiDigits.word($0) }
+        return AsciiDigits.parse8(word).map { Int($0) }
+    }
+
+    /// ISO 4217 numeric currency code, e.g. 152 for CLP.
+    var currency: Int? {
+        return withUnsafeBytes(of: reply.currency) { AsciiDigits.parse($0) }.map { Int($0) }
+    }
+
+    var authorizationNumber: String {
+        return withUnsafeBytes(of: reply.authorizationNumber) { TransactionReplyView.text($0) }
+    }
+
+    /// Gives temporary access to `zoneRep` (e.g. for `TLVReader`) without copying it.
+    func withZoneRep<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+        return try withUnsafeBytes(of: reply.zoneRep) { try body($0) }
+    }
+
+    func withZonePriv<R>(_ body: (UnsafeRawBufferPointer) throws -> R) rethrows -> R {
+        return try withUnsafeBytes(of: reply.zonePriv) { try body($0) }
+    }
+
+    var outcome: TransactionOutcome {
+        var currencyCode: (UInt8, UInt8, UInt8) = (0, 0, 0)
+        withUnsafeBytes(of: reply.currency) { bytes in
+            currencyCode = (bytes[0], bytes[1], bytes[2])
+        }
+        return TransactionOutcome(posNumber: posNumber, operationStatus: operationStatus, amount: amount,
+                                  currencyCode: currencyCode, authorizationNumber: authorizationNumber)
+    }
+
+    /// Bytes up to the first NUL, without trailing spaces.
+    static func text(_ bytes: UnsafeRawBufferPointer) -> String {
+        var end = bytes.firstIndex(of: 0) ?? bytes.count
+        while end > 0 && bytes[end - 1] == 0x20 {
+            end -= 1
+        }
+        return String(decoding: UnsafeRawBufferPointer(rebasing: bytes[0..<end]), as: UTF8.self)
+    }
+}
+
+/// The app's own record of a finished standalone transaction.
+struct TransactionOutcome: Equatable {
+    let posNumber: Int
+    let operationStatus: UInt8
+    let amount: Int?
+    let currencyCode: (UInt8, UInt8, UInt8)
+    let authorizationNumber: String
+
+    init(posNumber: Int, operationStatus: UInt8, amount: Int?, currencyCode: (UInt8, UInt8, UInt8), authorizationNumber: String) {
+        self.posNumber = posNumber
+        self.operationStatus = operationStatus
+        self.amount = amount
+        self.currencyCode = currencyCode
+        self.authorizationNumber = authorizationNumber
+    }
+
+    /// From the Objective-C wrapper, for replies delivered through `transactionDidEndWithTimeoutFlag:reply:`.
+    init(_ object: ICTransactionReplyObject) {
+        var currencyCode: (UInt8, UInt8, UInt8) = (0, 0, 0)
+        let currency = Array((object.currency ?? "").utf8.prefix(3))
+        if currency.count == 3 {
+            currencyCode = (currency[0], currency[1], currency[2])
+        }
+        self.init(posNumber: object.posNumber, operationStatus: object.operationStatus, amount: object.amount,
+                  currencyCode: currencyCode, authorizationNumber: object.authorizationNumber ?? "")
+    }
+
+    static func == (lhs: TransactionOutcome, rhs: TransactionOutcome) -> Bool {
+        return lhs.posNumber == rhs.posNumber && lhs.operationStatus == rhs.operationStatus
+            && lhs.amount == rhs.amount && lhs.currencyCode == rhs.currencyCode
+            && lhs.authorizationNumber == rhs.authorizationNumber
+    }
+}
+
+extension ICTransactionRequest {
+
+    /// Builds the C request directly: amount as eight zero padded digits, currency as three
+    /// ASCII digits, and the account, transaction and authorization codes as their characters.
+    static func make(amount: Int, currency: Int, posNumber: Int,
+                     accountType: ICTransactionAccountType = .all,
+                     transactionType: ICTransactionType = .debit,
+                     authorization: UInt8 = UInt8(ascii: "0")) -> ICTransactionRequest? {
+        guard amount >= 0, amount < 100_000_000, currency >= 0, currency < 1000, posNumber >= 0, posNumber <= 255 else {
+            return nil
+        }
+        var request = ICTransactionRequest()
+        request.posNumber = UInt16(posNumber)
+        request.accountType = accountType.rawValue
+        request.transactionType = transactionType.rawValue
+        request.authorization = authorization
+
+        var amountWord = AsciiDigits.format8(UInt32(amount)).littleEndian
+        withUnsafeBytes(of: &amountWord) { digits in
+            withUnsafeMutableBytes(of: &request.amount) { $0.copyMemory(from: digits) }
+        }
+
+        let currencyWord = AsciiDigits.format8(UInt32(currency)) >> 40
+        withUnsafeMutableBytes(of: &request.currency) { bytes in
+            for index in 0..<3 {
+                bytes[index] = UInt8(truncatingIfNeeded: currencyWord >> UInt64(index * 8))
+            }
+        }
+        return request
+    }
+
+    var amountValue: Int? {
+        let word = withUnsafeBytes(of: self.amount) { AsciiDigits.word($0) }
+        return AsciiDigits.parse8(word).map { Int($0) }
+    }
+}
@@ -15,9 +15,32 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     var pclService = ICPclService.shared()//NEEDED
     var terminals: [ICTerminal] = []
     var utils = mPosIntegrado()
+    let sessionHost = TerminalSessionHost()
+    var session: TerminalSession?
+    var commandsToken = CancellationToken()
+    let pclStrand = CallbackExecutor.shared.strand("pcl")
+    let logStrand = CallbackExecutor.shared.strand("log")
     
     var isConnected = false
-    
+
+    var receiptPrinter: EscPosReceiptPrinter? = nil//OPTIONAL EXTERNAL ESC/POS PRINTER
+    var terminalTCPPort: UInt16? = nil//PUERTO DEL POS INTEGRADO EN TERMINALES IP; nil USA mPosIntegrado
+    var useSPPLink = false//SOLO CON UN DISPOSITIVO SPP DETRAS DEL TERMINAL; EL POS INTEGRADO VA POR mPosIntegrado
+    var signatureView: SignatureView?
+    var pendingSignature: Data?//FIRMA DE LA VENTA EN CURSO, SE GUARDA CON LA VENTA APROBADA
+    let offlineQueue = OfflineQueue(url: OfflineQueue.defaultURL())
+    var serverReachable = true
+    var reachability: AnyObject?
+    let journal = SalesJournal()
+    let scanAggregator = ScanAggregator()
+    let catalog = CatalogStore()
+    lazy var barcodeReader = BarcodeReaderAdapter(aggregator: scanAggregator)
+    lazy var settlement: SettlementEngine = {
+        let settlement = SettlementEngine(journal: self.journal)
+        settlement.closeUnreconciled = true//EL CIERRE MANUAL SIEMPRE SE ENVÍA; EL DESCUADRE SOLO SE INFORMA
+        return settlement
+    }()
+
     @IBOutlet weak var StatusLabel: UILabel!
     
     @IBOutlet weak var ResponseLabel: UILabel!
@@ -39,14 +62,24 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     override func viewDidLoad() {
         super.viewDidLoad()
         self.pclService?.delegate=self
-        utils.onFinishTransaction =
-            {
-                result in
-                // DO SOMETHING WITH THE RESPONSE
-                self.processMessage(message: result)
-                // DO SOMETHING WITH THE RESPONSE
-                
-        }//NEEDED TO CAPTURE RESULT OF TRANSACTION
+        if #available(iOS 12.0, *) {
+            let reachability = ServerReachability()
+            /* NWPathMonitor avisa en su propia cola; el estado de la pantalla y el PCL se tocan en el hilo principal */
+            reachability.onChange = { reachable in
+                CallbackExecutor.ui {
+                    self.serverConnectionChanged(reachable)
+                }
+            }
+            reachability.start()
+            self.reachability = reachability
+        }
+        try? catalog.load(contentsOf: CatalogStore.defaultURL())
+        scanAggregator.onBatch = { barcodes in
+            self.scanned(barcodes)
+        }
+        scanAggregator.onRejected = { _, _ in
+            Toast.show(message: "Código no válido", controller: self)
+        }
         // Do any additional setup after loading the view, typically from a nib.
     }
 
@@ -76,6 +109,10 @@ class ViewController: UIViewController,ICPclServiceDelegate {
         if(terminals != [] )
         {
             let terminalselected = terminals[0]
+            guard let link = link(for: terminalselected) else {
+                return
+            }
+            session = sessionHost.open(identifier: terminalselected.name ?? "", terminal: terminalselected, link: link)
             
             if(self.startPclService(terminal: terminalselected, sslParameters: self.ssl ) != PCL_SERVICE_STARTED) {
                 Toast.show(message: "No se pudo conectar al POS", controller: self)
@@ -87,30 +124,172 @@ class ViewController: UIViewController,ICPclServiceDelegate {
         }
     }
     
+    /*Terminales IP con puerto configurado van por TCP directo, SPP solo si se pidió con useSPPLink; el resto por mPosIntegrado; nil si falla el certificado TLS*/
+    func link(for terminal: ICTerminal) -> PosLink?
+    {
+        if #available(iOS 12.0, *), let port = terminalTCPPort {
+            do {
+                if let link = try TCPLink(terminal: terminal, port: port, ssl: self.ssl) {
+                    return link
+                }
+            } catch {
+                Toast.show(message: "No se pudo cargar el certificado TLS del POS (\(error))", controller: self)
+                return nil
+            }
+        }
+        if useSPPLink, terminal.isBluetooth, let channel = ICSPP.sharedChannel(), channel.isAvailable {
+            return SPPLink(channel: channel)
+        }
+        return MposIntegradoLink(utils: utils)//NEEDED TO CAPTURE RESULT OF TRANSACTION
+    }
+    
+    /*Los callbacks del SDK se procesan fuera del hilo principal; solo la actualización de UIKit vuelve a él*/
     public func notifyConnection(_ sender: ICPclService!)
     {
-        //DO SOMETHING WHEN THE SERVER IS CONNECTED
-        StatusLabel.text = "Conectado"
-        StatusLabel.textColor = UIColor.systemGreen
-        togleConnectionButton.setTitle("Desconectar", for: .normal)
-        isConnected = true
+        CallbackExecutor.ui {
+            //DO SOMETHING WHEN THE SERVER IS CONNECTED
+            self.StatusLabel.text = "Conectado"
+            self.StatusLabel.textColor = UIColor.systemGreen
+            self.togleConnectionButton.setTitle("Desconectar", for: .normal)
+            self.isConnected = true
+            if let reader = ICBarCodeReader.sharedICBarCodeReader() {
+                self.barcodeReader.attach(to: reader)
+            }
+        }
     }
     
     public func notifyDisconnection(_ sender: ICPclService!)
     {
-        //DO SOMETHING WHEN THE SERVER IS DISCONNECTED
-        StatusLabel.text = "Desconectado"
-        StatusLabel.textColor = UIColor.systemRed
-        togleConnectionButton.setTitle("Conectar", for:.normal)
-        isConnected = false
+        session?.cancelAll()
+        CallbackExecutor.ui {
+            //DO SOMETHING WHEN THE SERVER IS DISCONNECTED
+            self.StatusLabel.text = "Desconectado"
+            self.StatusLabel.textColor = UIColor.systemRed
+            self.togleConnectionButton.setTitle("Conectar", for:.normal)
+            self.isConnected = false
+            self.barcodeReader.detach()
+        }
     }
     
     /*Este callback se usa para mostrar un log en consola del progreso*/
     public func pclLogEntry(_ message: String!, withSeverity severity: Int32)
     {
-        print("\(ICPclService.severityLevelString(severity) ?? "") \(message ?? "")")
+        let message = message ?? ""
+        logStrand.async {
+            print("\(ICPclService.severityLevelString(severity) ?? "") \(message)")
+        }
     }
-    
+
+    /*Mensajes que la aplicación del terminal envía por el canal PCL*/
+    public func receiveMessage(_ data: Data!)
+    {
+        guard let data = data else { return }
+        pclStrand.async {
+            let message = PosResponse(payload: data)
+            print("PCL message: \(message.text)")
+            CallbackExecutor.ui {
+                self.ResponseTextView.text = message.text
+            }
+        }
+    }
+
+    /*Transacciones iniciadas con doTransactionWithRequest: el SDK entrega el objeto Objective-C*/
+    public func transactionDidEnd(withTimeoutFlag replyReceived: Bool, reply transactionReply: ICTransactionReplyObject!)
+    {
+        guard let transactionReply = transactionReply else { return }
+        pclStrand.async {
+            self.transactionEnded(replyReceived, TransactionOutcome(transactionReply))
+        }
+    }
+
+    /*doTransaction y doTransactionEx: el struct se lee en su lugar con TransactionReplyView, sin pasar por el objeto*/
+    public func transactionDidEnd(withTimeoutFlag replyReceived: Bool, result transactionReply: ICTransactionReply, andData extendedData: Data!)
+    {
+        pclStrand.async {
+            self.transactionEnded(replyReceived, TransactionReplyView(transactionReply).outcome)
+        }
+    }
+
+    func transactionEnded(_ replyReceived: Bool, _ outcome: TransactionOutcome)
+    {
+        print("Transaction reply: \(outcome)")
+        CallbackExecutor.ui {
+            if !replyReceived {
+                Toast.show(message: "Tiempo de transacción excedido", controller: self)
+            } else {
+                self.ResponseTextView.text = "Autorización \(outcome.authorizationNumber)"
+            }
+        }
+    }
+
+    /*Los callbacks de impresión se envían a una impresora ESC/POS externa si está configurada*/
+    public func shouldPrintText(_ text: String!, with font: UIFont!, alignment: NSTextAlignment, xScaling xFactor: Int, yScaling yFactor: Int, underline: Bool, bold: Bool)
+    {
+        session?.advance(to: .printing)
+        let style = EscPosReceiptPrinter.TextStyle(alignment: alignment, xScale: xFactor, yScale: yFactor, underline: underline, bold: bold)
+        receiptPrinter?.printText(text ?? "", style: style)
+    }
+
+    public func shouldPrintRawText(_ text: UnsafeMutablePointer<CChar>!, withCharset charset: Int, with font: UIFont!, alignment: NSTextAlignment, xScaling xFactor: Int, yScaling yFactor: Int, underline: Bool, bold: Bool)
+    {
+        guard let text = text else { return }
+        let style = EscPosReceiptPrinter.TextStyle(alignment: alignment, xScale: xFactor, yScale: yFactor, underline: underline, bold: bold)
+        receiptPrinter?.printRawText(Data(bytes: text, count: strlen(text)), style: style)
+    }
+
+    public func shouldPrint(_ image: UIImage!)
+    {
+        guard let image = image else { return }
+        receiptPrinter?.printImage(image)
+    }
+
+    public func shouldFeedPaper(withLines lines: Int)
+    {
+        receiptPrinter?.feed(lines: lines)
+    }
+
+    public func shouldCutPaper()
+    {
+        receiptPrinter?.cut()
+    }
+
+    public func shouldEndReceipt() -> Int
+    {
+        receiptPrinter?.endReceipt()
+        return 0
+    }
+
+    /*El terminal pide la firma: se captura como trazos y se rasteriza solo al enviarla*/
+    public func shouldDoSignatureCapture(_ signatureData: ICSignatureData)
+    {
+        DispatchQueue.main.async {
+            self.signatureView?.removeFromSuperview()
+            let recorder = SignatureRecorder(signatureData: signatureData)
+            let frame = CGRect(x: Int(signatureData.screenX), y: Int(signatureData.screenY), width: recorder.width, height: recorder.height)
+            let signatureView = SignatureView(recorder: recorder, frame: frame)
+            signatureView.onSubmit = { recorder in
+                recorder.simplify()
+                self.pendingSignature = recorder.archive()
+                if self.pclService?.submitSignature(with: recorder.rasterize()) != true {
+                    Toast.show(message: "No se pudo enviar la firma", controller: self)
+                }
+                self.signatureView?.removeFromSuperview()
+                self.signatureView = nil
+            }
+            self.view.addSubview(signatureView)
+            self.signatureView = signatureView
+        }
+    }
+
+    public func signatureTimeoutExceeded()
+    {
+        DispatchQueue.main.async {
+            self.signatureView?.removeFromSuperview()
+            self.signatureView = nil
+            Toast.show(message: "Tiempo de firma excedido", controller: self)
+        }
+    }
+
     @IBAction func togleConnection(_ sender: UIButton) {
         if (!isConnected) {
             self.SelecTerminalAndStartPCLDemo()
@@ -120,6 +299,12 @@ class ViewController: UIViewController,ICPclServiceDelegate {
         StatusLabel.text = "Desconectado"
         StatusLabel.textColor = UIColor.systemRed
         togleConnectionButton.setTitle("Conectar", for:.normal)
+        commandsToken.cancel()
+        commandsToken = CancellationToken()
+        if let session = session {
+            sessionHost.close(session.identifier)
+            self.session = nil
+        }
         self.pclService?.stop()
     }
         
@@ -127,7 +312,44 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     {
         if(terminalIsConnected())
         {
-            sendToPOS(command: "0800")
+            let formatter = DateFormatter()
+            formatter.dateFormat = "yyyy-MM-dd"
+            let keyLoad = KeyLoadOrchestrator(rotation: formatter.string(from: Date()))
+            /* Una corrida terminada se repite completa; una interrumpida se reanuda salvo que se pida recargar todos */
+            guard keyLoad.hasUnfinishedRun else {
+                runKeyLoad(keyLoad, force: true)
+                return
+            }
+            let alert = UIAlertController(title: "Carga de llaves interrumpida",
+                                          message: "Se puede continuar con los terminales pendientes o recargar todos",
+                                          preferredStyle: .alert)
+            let resume = UIAlertAction(title: "Reanudar", style: .default) { _ in
+                self.runKeyLoad(keyLoad, force: false)
+            }
+            alert.addAction(resume)
+            alert.addAction(UIAlertAction(title: "Recargar todos", style: .destructive) { _ in
+                self.runKeyLoad(keyLoad, force: true)
+            })
+            alert.preferredAction = resume
+            present(alert, animated: true)
+        }
+    }
+    
+    func runKeyLoad(_ keyLoad: KeyLoadOrchestrator, force: Bool)
+    {
+        keyLoad.run(sessionHost.sessions, force: force, token: commandsToken) { progress in
+            let text = progress.keys.sorted().map { terminal -> String in
+                let entry = progress[terminal]!
+                switch entry.state {
+                case .loaded:
+                    return "\(terminal): llaves cargadas"
+                case .failed, .pending:
+                    return "\(terminal): falló tras \(entry.attempts) intentos (\(entry.lastError ?? ""))"
+                }
+            }.joined(separator: "\n")
+            CallbackExecutor.ui {
+                self.ResponseTextView.text = text
+            }
         }
     }
     
@@ -143,7 +365,7 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     {
         if(terminalIsConnected())
         {
-            sendToPOS(command: "0700||")
+            settle(close: false)
         }
     }
     
@@ -151,7 +373,7 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     {
         if(terminalIsConnected())
         {
-            sendToPOS(command: "0500|0")
+            settle(close: true)
         }
     }
     
@@ -159,7 +381,24 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     {
         if(terminalIsConnected())
         {
-            sendToPOS(command: "0260|1")
+            /*Los registros se muestran a medida que llegan; no se acumula la respuesta completa*/
+            ResponseTextView.text = ""
+            session?.details(token: commandsToken, onRecord: { record in
+                let line = "Operación \(record.operationNumber): $\(record.amount) \(record.cardBrand) **** \(record.last4Digits) \(record.realDate) \(record.realTime)\n"
+                CallbackExecutor.ui {
+                    self.ResponseTextView.text += line
+                }
+                return true
+            }, completion: { result in
+                CallbackExecutor.ui {
+                    switch result {
+                    case .success(let count):
+                        self.ResponseTextView.text += "\(count) transacciones"
+                    case .failure(let error):
+                        Toast.show(message: self.message(for: error), controller: self)
+                    }
+                }
+            })
         }
     }
     
@@ -177,9 +416,35 @@ class ViewController: UIViewController,ICPclServiceDelegate {
             return
         }
         
+        if(!serverReachable && offlineQueue != nil)
+        {
+            offlineQueue?.enqueue("0200|\(amount)|123456|||0")
+            Toast.show(message: "Sin conexión: la venta quedó pendiente y se pedirá confirmarla al recuperar la conexión", controller: self)
+            return
+        }
+        
         if(terminalIsConnected())
         {
-            sendToPOS(command: "0200|\(amount)|123456|||0")
+            let terminal = session?.identifier ?? ""
+            pendingSignature = nil
+            session?.sale(amount: amount, token: commandsToken) { result in
+                if case .success(let response) = result {
+                    self.journal.record(response, terminal: terminal)
+                    CallbackExecutor.ui {
+                        if let signature = self.pendingSignature, response.isApproved {
+                            self.journal.attachSignature(signature, terminal: terminal, operationNumber: response.operationNumber)
+                        }
+                        self.pendingSignature = nil
+                    }
+                }
+                self.processResult(result) { response in
+                    "Venta \(response.isApproved ? "aprobada" : "rechazada (\(response.responseCode))")\n"
+                        + "Autorización: \(response.authorizationCode)\n"
+                        + "Operación: \(response.operationNumber)\n"
+                        + "Monto: \(response.amount)\n"
+                        + "Tarjeta: \(response.cardBrand) \(response.last4Digits)"
+                }
+            }
         }
     }
     
@@ -187,7 +452,13 @@ class ViewController: UIViewController,ICPclServiceDelegate {
     {
         let operationNumber = Int(opNumberTextField.text ?? "") ?? 0
         
-        if(operationNumber > 0) {
+        /*Sin número de operación se busca la venta en el journal local*/
+        if(operationNumber == 0) {
+            searchSaleToRefund()
+            return
+        }
+        
+        if(operationNumber < 0) {
             Toast.show(message: "El número de operación debe ser mayor a 0", controller: self)
             return
         }
@@ -197,12 +468,166 @@ class ViewController: UIViewController,ICPclServiceDelegate {
             return
         }
         
+        sendRefund(operationNumber: operationNumber)
+    }
+    
+    func sendRefund(operationNumber: Int)
+    {
         if(terminalIsConnected())
         {
-            sendToPOS(command: "1200|\(operationNumber)|")
+            let terminal = session?.identifier ?? ""
+            session?.refund(operationNumber: operationNumber, token: commandsToken) { result in
+                if case .success(let response) = result {
+                    self.journal.recordRefund(response, of: operationNumber, terminal: terminal)
+                }
+                self.processResult(result) { response in
+                    "Anulación \(response.isApproved ? "aprobada" : "rechazada (\(response.responseCode))")\n"
+                        + "Autorización: \(response.authorizationCode)\n"
+                        + "Operación: \(response.operationNumber)"
+                }
+            }
         }
     }
     
+    /*Busca la venta a anular por monto, últimos 4 dígitos, código de autorización y antigüedad*/
+    func searchSaleToRefund()
+    {
+        let alert = UIAlertController(title: "Buscar venta", message: "Complete uno o más campos", preferredStyle: .alert)
+        let fields: [(String, UIKeyboardType)] = [("Monto", .numberPad), ("Últimos 4 dígitos", .numberPad),
+                                                  ("Código de autorización", .asciiCapable), ("Últimas horas", .numberPad)]
+        for (placeholder, keyboard) in fields {
+            alert.addTextField { field in
+                field.placeholder = placeholder
+                field.keyboardType = keyboard
+            }
+        }
+        alert.textFields?[0].text = amountTextField.text
+        alert.addAction(UIAlertAction(title: "Cancelar", style: .cancel))
+        alert.addAction(UIAlertAction(title: "Buscar", style: .default) { [unowned alert] _ in
+            let values = (alert.textFields ?? []).map { ($0.text ?? "").trimmingCharacters(in: .whitespaces) }
+            var query = RefundIndex.Query()
+            if let amount = Int(values[0]) {
+                query.amount = amount...amount
+            }
+            if !values[1].isEmpty {
+                query.last4Digits = values[1]
+            }
+            if !values[2].isEmpty {
+                query.authorizationCode = values[2]
+            }
+            if let hours = Double(values[3]) {
+                query.dates = Date(timeIntervalSinceNow: -hours * 3600)...Date()
+            }
+            let matches = self.journal.refundableSales(query)
+            if(matches.count != 1) {
+                self.ResponseTextView.text = matches.isEmpty ? "No hay ventas que coincidan" : matches.map {
+                    "Operación \($0.operationNumber): $\($0.amount) **** \($0.last4Digits) autorización \($0.authorizationCode)"
+                }.joined(separator: "\n")
+                return
+            }
+            self.opNumberTextField.text = String(matches[0].operationNumber)
+            self.sendRefund(operationNumber: matches[0].operationNumber)
+        })
+        present(alert, animated: true)
+    }
+    
+    /*Totales y cierre de todos los terminales abiertos, conciliados contra el journal local*/
+    func settle(close: Bool)
+    {
+        settlement.settle(sessionHost.sessions, close: close, token: commandsToken) { reports in
+            let text = reports.map { report -> String in
+                var line = "\(report.terminal): "
+                if let totals = report.totals {
+                    line += "\(totals.transactionCount) ventas por $\(totals.transactionTotal)"
+                    line += report.isReconciled ? " (cuadrado)" : " (DESCUADRADO, journal: \(report.journalCount) por $\(report.journalAmount))"
+                }
+                if let error = report.error {
+                    line += " error: \(self.message(for: error))"
+                }
+                if close && (report.error == nil || report.close != nil) {
+                    line += report.isClosed ? ", cerrado" : ", sin cerrar"
+                }
+                return line
+            }.joined(separator: "\n")
+            CallbackExecutor.ui {
+                self.ResponseTextView.text = text
+            }
+        }
+    }
+    
+    /*Cada ráfaga del lector se busca en el catálogo y se muestra junta*/
+    func scanned(_ barcodes: [DecodedBarcode])
+    {
+        let lines = barcodes.map { barcode -> String in
+            "\(barcode.data): \(catalog.lookup(barcode) ?? "no está en el catálogo")"
+        }
+        ResponseTextView.text = lines.joined(separator: "\n")
+    }
+    
+    /*Informa al terminal del estado del servidor y ofrece reenviar las ventas guardadas al reconectar*/
+    func serverConnectionChanged(_ reachable: Bool)
+    {
+        serverReachable = reachable
+        _ = pclService?.setServerConnectionState(reachable)
+        guard reachable, let session = session, let offlineQueue = offlineQueue else {
+            return
+        }
+        let terminal = session.identifier
+        var approved = 0
+        offlineQueue.drain(maximumConcurrent: 1, send: { operation, done in
+            /* La tarjeta ya no está: cada venta guardada se confirma con el operador antes de pedirla de nuevo al POS */
+            CallbackExecutor.ui {
+                self.confirmReplay(operation) { replay in
+                    guard replay else {
+                        done(true)
+                        return
+                    }
+                    session.request(operation.command, as: SaleResponse.self, token: self.commandsToken) { result in
+                        switch result {
+                        case .success(let response) where response.isApproved:
+                            self.journal.record(response, terminal: terminal)
+                            approved += 1
+                            done(true)
+                        case .success(let response):
+                            /* Rechazada: queda pendiente y el operador decide en la próxima reconexión */
+                            CallbackExecutor.ui {
+                                Toast.show(message: "Venta pendiente rechazada (\(response.responseCode))", controller: self)
+                            }
+                            done(false)
+                        case .failure(let error):
+                            CallbackExecutor.ui {
+                                Toast.show(message: self.message(for: error), controller: self)
+                            }
+                            done(false)
+                        }
+                    }
+                }
+            }
+        }, completion: { _ in
+            if approved > 0 {
+                CallbackExecutor.ui {
+                    Toast.show(message: "Se aprobaron \(approved) ventas pendientes", controller: self)
+                }
+            }
+        })
+    }
+    
+    /*Pregunta al operador si una venta guardada sin conexión se envía al POS o se descarta*/
+    func confirmReplay(_ operation: OfflineOperation, decision: @escaping (Bool) -> Void)
+    {
+        let fields = operation.command.split(separator: "|", omittingEmptySubsequences: false)
+        let amount = fields.count > 1 ? String(fields[1]) : "?"
+        let formatter = DateFormatter()
+        formatter.dateStyle = .short
+        formatter.timeStyle = .short
+        let alert = UIAlertController(title: "Venta pendiente",
+                                      message: "Venta por $\(amount) del \(formatter.string(from: operation.createdAt)). El cliente debe presentar la tarjeta nuevamente.",
+                                      preferredStyle: .alert)
+        alert.addAction(UIAlertAction(title: "Enviar al POS", style: .default) { _ in decision(true) })
+        alert.addAction(UIAlertAction(title: "Descartar", style: .destructive) { _ in decision(false) })
+        present(alert, animated: true)
+    }
+    
     func terminalIsConnected() -> Bool
     {
         if(pclService?.getState() == PCL_SERVICE_CONNECTED) {
@@ -213,47 +638,57 @@ class ViewController: UIViewController,ICPclServiceDelegate {
         return false
     }
     
-    func processMessage(message: String)
+    func processMessage(response: PosResponse)
     {
-        let asciiResponse = hexStringToAscii(hexString: message)
-        ResponseTextView.text = asciiResponse
+        ResponseTextView.text = response.text
         
-        print("Hex response: \(message)")
-        print("ASCII response: \(asciiResponse)")
+        print("ASCII response: \(response.text)")
     }
     
     func sendToPOS(command: String) {
-        let STX = String(UnicodeScalar(0x02))
-        let ETX = String(UnicodeScalar(0x03))
-        
-        let partialCommand = STX + command + ETX
-        let lrc = calculateLRC(command: partialCommand)
-        let fullCommand = partialCommand + String(UnicodeScalar(lrc))
-        let hexCommand = fullCommand.toHexEncodedString()
+        guard let session = session else {
+            Toast.show(message: "POS no conectado", controller: self)
+            return
+        }
         
-        utils.startTransaction(payload: hexCommand)
+        session.send(command, token: commandsToken) { result in
+            CallbackExecutor.ui {
+                switch result {
+                case .success(let response):
+                    // DO SOMETHING WITH THE RESPONSE
+                    self.processMessage(response: response)
+                case .failure(let error):
+                    Toast.show(message: self.message(for: error), controller: self)
+                }
+            }
+        }
     }
     
-    func calculateLRC(command: String) -> UInt8 {
-        var lrc = UInt8()
-        let range = command.index(after: command.startIndex)..<command.endIndex
-        
-        for char in command[range].utf8 {
-            lrc ^= char
+    /*Muestra una respuesta tipada; el texto se arma en la cola de la sesión*/
+    func processResult<R>(_ result: Result<R, PosError>, describe: (R) -> String) {
+        let text = result.map(describe)
+        CallbackExecutor.ui {
+            switch text {
+            case .success(let text):
+                self.ResponseTextView.text = text
+                print(text)
+            case .failure(let error):
+                Toast.show(message: self.message(for: error), controller: self)
+            }
         }
-        
-        return lrc
     }
     
-    func hexStringToAscii(hexString: String) -> String {
-        let pattern = "(0x)?([0-9a-f]{2})"
-        let regex = try! NSRegularExpression(pattern: pattern, options: .caseInsensitive)
-        let nsString = hexString as NSString
-        let matches = regex.matches(in: hexString, options: [], range: NSMakeRange(0, nsString.length))
-        let characters = matches.map {
-           Character(UnicodeScalar(UInt32(nsString.substring(with: $0.range(at: 2)), radix: 16)!)!)
+    func message(for error: PosError) -> String {
+        switch error {
+        case .timeout, .phaseTimeout:
+            return "El POS no respondió a tiempo"
+        case .cancelled:
+            return "Operación cancelada"
+        case .disconnected:
+            return "POS no conectado"
+        case .corruptedFrame, .rejected, .unexpectedResponse:
+            return "No se recibió una respuesta válida del POS"
         }
-        return String(characters)
     }
     
     class Toast {
@@ -301,10 +736,3 @@ class ViewController: UIViewController,ICPclServiceDelegate {
         }
     }
 }
-
-extension String {
-    func toHexEncodedString(uppercase: Bool = true, prefix: String = "", separator: String = "") -> String {
-        let format = uppercase ? "%02X" : "%02x"
-        return unicodeScalars.map { prefix + .init(format: format, $0.value) } .joined(separator: separator)
-    }
-}